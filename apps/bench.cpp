@@ -0,0 +1,240 @@
+#include "config.hpp"
+#include "position/game_state.hpp"
+#include "position/generate_moves.hpp"
+#include "position/make_move.hpp"
+#include "search/search_quiescent.hpp"
+#include "search/statistics.hpp"
+#include "utility/logging.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+// The starting position, the position from our evaluate regression suite, and a couple of the usual perft positions.
+constexpr std::array<const char*, 4> BENCH_FENS {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"
+};
+
+std::ostream& print_usage(const char* argv0, std::ostream& os)
+{
+    return os << "Usage: " << argv0 << " <options>\n"
+              << "    Options:\n"
+              << "         -h                   -> Print this help menu.\n"
+              << "         -f [fen]             -> The FEN string of a single position to benchmark. Optional, defaults to the standard positions.\n"
+              << "         -d [depth]           -> The depth of the tree to walk. Optional, default 4 (quiescence search is run from the leaves one ply shallower).\n"
+              << "         -k [hash-table size] -> The size of the hash-table (in MiB). Optional, default 1000.\n";
+}
+
+struct walk_result
+{
+    std::size_t nodes;
+    std::size_t hits;
+};
+
+// Walks the full tree to the given depth probing the transposition table on entering every node, exactly as the search does.
+// The only difference between the two variants we time is whether make-move prefetches the bucket of the new position.
+template <typename Prefetch>
+void walk(game_state& gs, std::size_t depth, std::span<std::uint32_t> move_buf, walk_result& result, Prefetch prefetch)
+{
+    result.nodes++;
+
+    ::details::search_value_type entry {};
+    if (gs.tt->probe(gs.hash, entry))
+        result.hits++;
+
+    if (depth == 0)
+        return;
+
+    const std::size_t moves { generate_pseudo_legal_moves(gs.bb, move_buf) };
+    const std::span<std::uint32_t> move_list = move_buf.subspan(0, moves);
+
+    for (const auto make : move_list)
+    {
+        std::uint32_t unmake;
+        const bool legal { ::details::make_move_impl({ .check_legality = true }, gs.bb, make, unmake, gs.hash, gs.pawn_hash, gs.piece_square_eval, prefetch) };
+        gs.bb.ply_counter++;
+
+        if (legal) [[likely]]
+            walk(gs, depth-1, move_buf.subspan(moves), result, prefetch);
+
+        unmake_move(gs, make, unmake);
+    }
+
+    // Store something so that the table fills up like it would in a search.
+    gs.tt->store(gs.hash, { .age=gs.age, .depth=static_cast<std::uint8_t>(depth), .eval=0, .best_move=0, .meta=0 });
+}
+
+template <typename Prefetch>
+std::chrono::nanoseconds time_walk(game_state& gs, std::size_t depth, walk_result& result, Prefetch prefetch)
+{
+    std::vector<std::uint32_t> move_buf(depth*256);
+
+    // Start each variant from the same empty table.
+    gs.tt->clear();
+
+    const auto start { std::chrono::steady_clock::now() };
+    walk(gs, depth, move_buf, result, prefetch);
+    return std::chrono::steady_clock::now() - start;
+}
+
+// Walks the full tree to the given depth, running a full-window quiescence search from every leaf. Quiescence nodes are where
+// almost all of the static evaluation happens, so this is our measure of evaluation throughput.
+void walk_quiescence(game_state& gs, std::size_t depth, std::span<std::int64_t> move_buf, search::statistics& stats)
+{
+    if (depth == 0)
+    {
+        constexpr int inf { std::numeric_limits<int>::max() };
+        search::search_quiescence(gs, stats, 0, -inf, inf, gs.bb.is_black_to_play() ? -1 : 1, move_buf);
+        return;
+    }
+
+    std::array<std::uint32_t, MAX_MOVES_PER_POSITION> moves_buf;
+    const std::size_t moves { generate_pseudo_legal_moves(gs.bb, std::span<std::uint32_t>(moves_buf)) };
+
+    for (std::size_t i = 0; i < moves; i++)
+    {
+        std::uint32_t unmake;
+        if (make_move({ .check_legality = true }, gs, moves_buf[i], unmake)) [[likely]]
+            walk_quiescence(gs, depth-1, move_buf, stats);
+
+        unmake_move(gs, moves_buf[i], unmake);
+    }
+}
+
+std::chrono::nanoseconds time_walk_quiescence(game_state& gs, std::size_t depth, search::statistics& stats)
+{
+    std::vector<std::int64_t> move_buf(1024*MAX_MOVES_PER_POSITION);
+
+    const auto start { std::chrono::steady_clock::now() };
+    walk_quiescence(gs, depth, move_buf, stats);
+    return std::chrono::steady_clock::now() - start;
+}
+
+double get_ns_per_node(std::chrono::nanoseconds time, std::size_t nodes)
+{
+    return nodes ? static_cast<double>(time.count()) / nodes : 0.0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    // Default arguments.
+    bool help                         { false };
+    std::vector<std::string> fens     { BENCH_FENS.begin(), BENCH_FENS.end() };
+    std::size_t depth                 { 4 };
+    std::size_t hash_table_size_bytes { 1000000000ULL };
+
+    // Parse options.
+    for (int c; (c = getopt(argc, argv, "hf:d:k:")) != -1; )
+    {
+        switch (c)
+        {
+            // Help.
+            case 'h':
+            {
+                help = true;
+                break;
+            }
+            // FEN.
+            case 'f':
+            {
+                fens = { optarg };
+                break;
+            }
+            // Depth.
+            case 'd':
+            {
+                depth = std::stoull(optarg);
+                break;
+            }
+            // Hash size.
+            case 'k':
+            {
+                hash_table_size_bytes = std::stoull(optarg)*1000000;
+                break;
+            }
+            // Unknown
+            case '?':
+            {
+                if (optopt == 'f' || optopt == 'd' || optopt == 'k')
+                {
+                    std::cerr << "Option requires argument.\n";
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            default:
+                std::cerr << "Could not parse commandline arguments.\n";
+                print_usage(argv[0], std::cerr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    // Just print usage menu and return if we asked for help.
+    if (help)
+    {
+        print_usage(argv[0], std::cout);
+        return EXIT_SUCCESS;
+    }
+
+    // Setup the logger.
+    set_log_method(log_method::cerr);
+
+    game_state gs;
+    gs.reset();
+    gs.tt->set_table_bytes(hash_table_size_bytes);
+
+    std::cout << R"({)" << '\n'
+              << R"(    "config": )"; config::print_json(std::cout); std::cout << ",\n"
+              << R"(    "depth": )" << depth << ",\n"
+              << R"(    "hash-table MB": )" << '"' << gs.tt->get_table_bytes()/1000000 << '"' << ",\n"
+              << R"(    "hash-table pages": )" << '"' << details::to_string(gs.tt->get_table_memory().get_page_type()) << '"' << ",\n"
+              << R"(    "positions": [)" << '\n';
+
+    for (std::size_t i = 0; i < fens.size(); i++)
+    {
+        gs.load(bitboard(fens[i]));
+
+        walk_result result_plain {};
+        const auto time_plain { time_walk(gs, depth, result_plain, ::details::no_prefetch {}) };
+
+        walk_result result_prefetch {};
+        const auto time_prefetch { time_walk(gs, depth, result_prefetch, [&gs] (std::uint64_t hash, std::uint64_t) noexcept { gs.tt->prefetch(hash); }) };
+
+        search::statistics stats_quiescence {};
+        const auto time_quiescence { time_walk_quiescence(gs, depth > 0 ? depth-1 : 0, stats_quiescence) };
+
+        const double ns_plain    { get_ns_per_node(time_plain, result_plain.nodes) };
+        const double ns_prefetch { get_ns_per_node(time_prefetch, result_prefetch.nodes) };
+        const double ns_qnode    { get_ns_per_node(time_quiescence, stats_quiescence.qnodes) };
+
+        std::cout << R"(        {)" << '\n'
+                  << R"(            "fen": )" << '"' << fens[i] << '"' << ",\n"
+                  << R"(            "nodes": )" << result_plain.nodes << ",\n"
+                  << R"(            "tt-hits": )" << result_plain.hits << ",\n"
+                  << R"(            "ns-per-node": )" << std::fixed << std::setprecision(2) << ns_plain << ",\n"
+                  << R"(            "ns-per-node-prefetch": )" << ns_prefetch << ",\n"
+                  << R"(            "speedup": )" << (ns_prefetch > 0.0 ? ns_plain / ns_prefetch : 0.0) << ",\n"
+                  << R"(            "qnodes": )" << stats_quiescence.qnodes << ",\n"
+                  << R"(            "ns-per-qnode": )" << ns_qnode << ",\n"
+                  << R"(            "qnps": )" << static_cast<std::size_t>(ns_qnode > 0.0 ? 1e9 / ns_qnode : 0.0) << '\n'
+                  << R"(        })" << (i+1 < fens.size() ? "," : "") << '\n';
+    }
+
+    std::cout << R"(    ])" << '\n'
+              << R"(})" << '\n';
+
+    return EXIT_SUCCESS;
+}
@@ -6,6 +6,8 @@
 #include <cstring>
 #include <unistd.h>
 #include <iomanip>
+#include <limits>
+#include <string>
 
 static std::ostream& print_usage(const char* argv0, std::ostream& os)
 {
@@ -14,7 +16,9 @@ static std::ostream& print_usage(const char* argv0, std::ostream& os)
               << "         -h                   -> Print this help menu.\n"
               << "         -f [fen]             -> The FEN string for the starting position. Optional, defaults to starting position.\n"
               << "         -d [depth]           -> The evaluation depth. Optional, default 1.\n"
-              << "         -k [hash-table size] -> The size of the hash-table (in MiB) if used. Optional, default 1000.\n";
+              << "         -n [nodes]           -> Stop the search after this many nodes, for reproducible benchmarks. Optional, unlimited by default.\n"
+              << "         -k [hash-table size] -> The size of the hash-table (in MiB) if used. Optional, default 1000.\n"
+              << "         -j [threads]         -> The number of search threads. Optional, default 1.\n";
 }
 
 int main(int argc, char** argv)
@@ -23,10 +27,12 @@ int main(int argc, char** argv)
     bool help                         { false };
     std::string fen                   { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1" };
     std::size_t depth                 { 1 };
+    std::size_t nodes                 { std::numeric_limits<std::size_t>::max() };
     std::size_t hash_table_size_bytes { 1000000000ULL };
+    std::size_t threads               { 1 };
 
     // Parse options.
-    for (int c; (c = getopt(argc, argv, "hf:d:s:k:")) != -1; )
+    for (int c; (c = getopt(argc, argv, "hf:d:n:s:k:j:")) != -1; )
     {
         switch (c)
         {
@@ -48,16 +54,28 @@ int main(int argc, char** argv)
                 depth = std::stoull(optarg);
                 break;
             }
+            // Node limit.
+            case 'n':
+            {
+                nodes = std::stoull(optarg);
+                break;
+            }
             // Hash size.
             case 'k':
             {
                 hash_table_size_bytes = std::stoull(optarg)*1000000;
                 break;
             }
+            // Threads.
+            case 'j':
+            {
+                threads = std::max(std::stoull(optarg), 1ULL);
+                break;
+            }
             // Unknown
             case '?':
             {
-                if (optopt == 'f' || optopt == 'd')
+                if (optopt == 'f' || optopt == 'd' || optopt == 'n')
                 {
                     std::cerr << "Option requires argument.\n";
                     return EXIT_FAILURE;
@@ -87,10 +105,10 @@ int main(int argc, char** argv)
 
     // Init hash table, so we can read-back the actual allocated memory (instead of the requested amount) when
     // printing out the telemetry below.
-    gs.tt.set_table_bytes(hash_table_size_bytes);
+    gs.tt->set_table_bytes(hash_table_size_bytes);
 
     search::statistics stats {};
-    const search::recommendation rec { search::recommend_move(gs, stats, depth) };
+    const search::recommendation rec { search::recommend_move(gs, stats, { .depth=depth, .nodes=nodes }, search::time_manager::fixed(std::chrono::hours(2)), threads) };
 
     // Start printing the JSON file in one go. We might clean this up later by having a proper JSON printing class, but this
     // program seems too simple at the moment to warrant it.
@@ -98,7 +116,11 @@ int main(int argc, char** argv)
               << R"(    "fen": )"   << '"' << fen << '"' << ",\n"
               << R"(    "config": )"; config::print_json(std::cout); std::cout << ",\n"
               << R"(    "depth": )" << stats.depth << ",\n"
-              << R"(    "hash-table MB": )" << '"' << gs.tt.get_table_bytes()/1000000 << '"' << ",\n"
+              << R"(    "node-limit": )" << (nodes == std::numeric_limits<std::size_t>::max() ? "null" : std::to_string(nodes)) << ",\n"
+              << R"(    "threads": )" << threads << ",\n"
+              << R"(    "hash-table MB": )" << '"' << gs.tt->get_table_bytes()/1000000 << '"' << ",\n"
+              << R"(    "hash-table pages": )" << '"' << details::to_string(gs.tt->get_table_memory().get_page_type()) << '"' << ",\n"
+              << R"(    "hash-table numa": )" << '"' << details::to_string(gs.tt->get_table_memory().get_numa_policy()) << '"' << ",\n"
               << R"(    "time-ms": )" << std::chrono::duration_cast<std::chrono::milliseconds>(stats.time).count() << ",\n"
               << R"(    "pv": )" << '"' << move::to_algebraic_long(stats.pv) << '"' << ",\n"
               << R"(    "evaluation-cp": )" << rec.eval << ",\n"
@@ -130,6 +152,10 @@ int main(int argc, char** argv)
               << R"(    "tt-probes": )" << stats.tt_probes << ",\n"
               << R"(    "tt-hits": )" << stats.tt_hits << ",\n"
               << R"(    "tt-hit-rate": )" << std::setprecision(2) << stats.get_tt_hit_rate() << ",\n"
+              << R"(    "tt-hashfull": )" << stats.tt_hashfull << ",\n"
+              << R"(    "eval-cache-probes": )" << stats.eval_cache_probes << ",\n"
+              << R"(    "eval-cache-hits": )" << stats.eval_cache_hits << ",\n"
+              << R"(    "eval-cache-hit-rate": )" << std::setprecision(2) << stats.get_eval_cache_hit_rate() << ",\n"
               << R"(    "aw-misses-low": )" << stats.aw_misses_low << ",\n"
               << R"(    "aw-misses-high": )" << stats.aw_misses_high << ",\n"
               << R"(    "aw-misses-total": )" << stats.get_aw_misses_total() << ",\n"
@@ -4,6 +4,7 @@
 #include "utility/perft.hpp"
 #include "utility/logging.hpp"
 
+#include <algorithm>
 #include <bits/chrono.h>
 #include <cstdlib>
 #include <string>
@@ -17,9 +18,13 @@ static std::ostream& print_usage(const char* argv0, std::ostream& os)
               << "    Options:\n"
               << "         -h                   -> Print this help menu.\n"
               << "         -t                   -> Also print the first level tree of possible moves.\n"
+              << "         -l                   -> Use the legal move generator rather than the pseudo-legal one.\n"
+              << "         -b                   -> Bulk-count the legal moves at the last ply rather than making and unmaking them.\n"
               << "         -f [fen]             -> The FEN string for the starting position. Optional, defaults to starting position.\n"
               << "         -d [depth]           -> The perft depth. Optional, default 1.\n"
-              << "         -k [hash-table size] -> The size of the hash-table (in MiB) if used. Optional, default 1000.\n";
+              << "         -k [hash-table size] -> The size of the hash-table (in MiB) if used. Optional, default 1000.\n"
+              << "         -j [threads]         -> The number of threads. Optional, default 1.\n"
+              << "         -p [split ply]       -> The ply at which the tree is split between the threads. Optional, default 1.\n";
 }
 
 int main(int argc, char** argv)
@@ -27,12 +32,16 @@ int main(int argc, char** argv)
     // Default arguments.
     bool help                         { false };
     bool tree                         { false };
+    perft_generator generator         { perft_generator::pseudo_legal };
+    perft_strategy strategy           { perft_strategy::make_unmake };
     std::string fen                   { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1" };
     std::size_t depth                 { 1 };
     std::size_t hash_table_size_bytes { 1000000000ULL };
+    std::size_t threads               { 1 };
+    std::size_t split_ply             { 1 };
 
     // Parse options.
-    for (int c; (c = getopt(argc, argv, "htf:d:s:k:")) != -1; )
+    for (int c; (c = getopt(argc, argv, "htlbf:d:s:k:j:p:")) != -1; )
     {
         switch (c)
         {
@@ -48,6 +57,18 @@ int main(int argc, char** argv)
                 tree = true;
                 break;
             }
+            // Legal move generator.
+            case 'l':
+            {
+                generator = perft_generator::legal;
+                break;
+            }
+            // Bulk-counting.
+            case 'b':
+            {
+                strategy = perft_strategy::bulk_count;
+                break;
+            }
             // FEN.
             case 'f':
             {
@@ -66,10 +87,22 @@ int main(int argc, char** argv)
                 hash_table_size_bytes = std::stoull(optarg)*1000000;
                 break;
             }
+            // Threads.
+            case 'j':
+            {
+                threads = std::max(std::stoull(optarg), 1ULL);
+                break;
+            }
+            // Split ply.
+            case 'p':
+            {
+                split_ply = std::max(std::stoull(optarg), 1ULL);
+                break;
+            }
             // Unknown
             case '?':
             {
-                if (optopt == 'f' || optopt == 'd' || optopt == 's' || optopt == 'k')
+                if (optopt == 'f' || optopt == 'd' || optopt == 's' || optopt == 'k' || optopt == 'j' || optopt == 'p')
                 {
                     std::cerr << "Option requires argument.\n";
                     return EXIT_FAILURE;
@@ -111,9 +144,16 @@ int main(int argc, char** argv)
     std::cout << R"({)" << '\n'
               << R"(    "fen": )"   << '"' << fen << '"' << ",\n"
               << R"(    "depth": )" << depth << ",\n"
-              << R"(    "hash-table MB": )"   << '"' << get_perft_hash_table_bytes()/1000000 << '"' << ",\n";
+              << R"(    "generator": )" << '"' << (generator == perft_generator::legal ? "legal" : "pseudo-legal") << '"' << ",\n"
+              << R"(    "strategy": )" << '"' << (strategy == perft_strategy::bulk_count ? "bulk-count" : "make-unmake") << '"' << ",\n"
+              << R"(    "threads": )" << threads << ",\n"
+              << R"(    "split-ply": )" << split_ply << ",\n"
+              << R"(    "hash-table MB": )"   << '"' << get_perft_hash_table_bytes()/1000000 << '"' << ",\n"
+              << R"(    "hash-table pages": )" << '"' << details::to_string(get_perft_hash_table_memory().get_page_type()) << '"' << ",\n"
+              << R"(    "hash-table numa": )"  << '"' << details::to_string(get_perft_hash_table_memory().get_numa_policy()) << '"' << ",\n";
 
     const bitboard position_start(fen);
+    const perft_args args { .generator=generator, .strategy=strategy, .threads=threads, .split_ply=split_ply };
     std::size_t total_nodes {};
 
     const auto time_start = std::chrono::steady_clock::now();
@@ -123,7 +163,7 @@ int main(int argc, char** argv)
 
         bool array_first { true };
         std::array<std::uint32_t, 256> move_buf;
-        const std::size_t moves { generate_pseudo_legal_moves(position_start, std::span<uint32_t>(move_buf)) };
+        const std::size_t moves { generator == perft_generator::legal ? generate_legal_moves(position_start, std::span<uint32_t>(move_buf)) : generate_pseudo_legal_moves(position_start, std::span<uint32_t>(move_buf)) };
         for (std::size_t i = 0; i < moves; i++)
         {
             bitboard next_position { position_start };
@@ -131,7 +171,7 @@ int main(int argc, char** argv)
             if (!make_move({ .check_legality = true }, next_position, move_buf[i]))
                 continue;
 
-            const std::size_t nodes { perft(next_position, depth-1) };
+            const std::size_t nodes { perft(next_position, depth-1, args) };
             total_nodes += nodes;
 
             // Handle trailing-comma printing.
@@ -149,7 +189,7 @@ int main(int argc, char** argv)
     }
     else
     {
-        total_nodes = perft(position_start, depth);
+        total_nodes = perft(position_start, depth, args);
     }
     const auto time_end = std::chrono::steady_clock::now();
 
@@ -0,0 +1,266 @@
+#include "utility/perft.hpp"
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+std::ostream& print_usage(const char* argv0, std::ostream& os)
+{
+    return os << "Usage: " << argv0 << " <options>\n"
+              << "    Options:\n"
+              << "         -h                   -> Print this help menu.\n"
+              << "         -e [suite]           -> The EPD file of positions with their expected node counts (;D1 20 ;D2 400 ...).\n"
+              << "         -d [max depth]       -> Skip the expected node counts deeper than this. Optional, runs all of them by default.\n"
+              << "         -l                   -> Use the legal move generator rather than the pseudo-legal one.\n"
+              << "         -b                   -> Bulk-count the legal moves at the last ply rather than making and unmaking them.\n"
+              << "         -v                   -> Verify the incremental hash and piece-square evaluation at every node (slow, ignores -b and -k).\n"
+              << "         -k [hash-table size] -> The size of the hash-table (in MiB) if used. Optional, default 0.\n"
+              << "         -j [threads]         -> The number of positions run in parallel. Optional, defaults to the number of hardware threads.\n";
+}
+
+std::size_t get_nps(std::size_t nodes, double duration)
+{
+    return duration > 0.0 ? static_cast<std::size_t>(static_cast<double>(nodes) / duration) : 0;
+}
+
+struct depth_result
+{
+    std::size_t depth;
+    std::size_t expected;
+    std::size_t nodes;
+    double duration;
+};
+
+struct position_result
+{
+    std::vector<depth_result> depths;
+    std::string error;
+
+    bool passed() const noexcept
+    {
+        return error.empty() && std::all_of(depths.begin(), depths.end(), [] (const auto& r) { return r.nodes == r.expected; });
+    }
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    // Default arguments.
+    bool help                         { false };
+    std::string suite_path;
+    std::size_t max_depth             { std::numeric_limits<std::size_t>::max() };
+    perft_generator generator         { perft_generator::pseudo_legal };
+    perft_strategy strategy           { perft_strategy::make_unmake };
+    bool verify                       { false };
+    std::size_t hash_table_size_bytes { 0 };
+    std::size_t threads               { std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+
+    // Parse options.
+    for (int c; (c = getopt(argc, argv, "he:d:lbvk:j:")) != -1; )
+    {
+        switch (c)
+        {
+            // Help.
+            case 'h':
+            {
+                help = true;
+                break;
+            }
+            // Suite.
+            case 'e':
+            {
+                suite_path = optarg;
+                break;
+            }
+            // Maximum depth.
+            case 'd':
+            {
+                max_depth = std::stoull(optarg);
+                break;
+            }
+            // Legal move generator.
+            case 'l':
+            {
+                generator = perft_generator::legal;
+                break;
+            }
+            // Bulk-counting.
+            case 'b':
+            {
+                strategy = perft_strategy::bulk_count;
+                break;
+            }
+            // Verification.
+            case 'v':
+            {
+                verify = true;
+                break;
+            }
+            // Hash size.
+            case 'k':
+            {
+                hash_table_size_bytes = std::stoull(optarg)*1000000;
+                break;
+            }
+            // Threads.
+            case 'j':
+            {
+                threads = std::max(std::stoull(optarg), 1ULL);
+                break;
+            }
+            default:
+                std::cerr << "Could not parse commandline arguments.\n";
+                print_usage(argv[0], std::cerr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    // Just print usage menu and return if we asked for help.
+    if (help)
+    {
+        print_usage(argv[0], std::cout);
+        return EXIT_SUCCESS;
+    }
+
+    if (suite_path.empty())
+    {
+        std::cerr << "A perft suite is required.\n";
+        print_usage(argv[0], std::cerr);
+        return EXIT_FAILURE;
+    }
+
+    // Setup the logger.
+    set_log_method(log_method::cerr);
+
+    std::vector<perft_suite_position> suite;
+    try
+    {
+        suite = load_perft_suite(suite_path);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // The verifying walk makes and unmakes every move without the hash table, so the other options don't apply to it.
+    if (verify)
+    {
+        strategy = perft_strategy::make_unmake;
+        hash_table_size_bytes = 0;
+    }
+    set_perft_hash_table_bytes(hash_table_size_bytes);
+
+    // The positions are run in parallel, with each thread taking the next position as soon as it's done with its last. Each
+    // position is counted on a single thread, so that its NPS is comparable from run to run.
+    std::vector<position_result> results(suite.size());
+    std::atomic<std::size_t> next {};
+
+    const auto work = [&] ()
+    {
+        for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < suite.size(); )
+        {
+            const bitboard bb { suite[i].fen };
+            try
+            {
+                for (const auto& expected : suite[i].expected)
+                {
+                    if (expected.depth > max_depth)
+                        break;
+
+                    const auto time_start = std::chrono::steady_clock::now();
+                    const std::size_t nodes { verify ? perft_verify(bb, expected.depth, generator)
+                                                     : perft(bb, expected.depth, { .generator=generator, .strategy=strategy }) };
+                    const auto time_end = std::chrono::steady_clock::now();
+
+                    results[i].depths.push_back({ expected.depth, expected.nodes, nodes, std::chrono::duration<double>(time_end - time_start).count() });
+                }
+            }
+            catch (const std::exception& e)
+            {
+                results[i].error = e.what();
+            }
+        }
+    };
+
+    const auto time_start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < std::min(threads, suite.size()); i++)
+        workers.emplace_back(work);
+    for (auto& worker : workers)
+        worker.join();
+    const auto time_end = std::chrono::steady_clock::now();
+
+    // Print the report as JSON, with a result for every depth of every position.
+    std::cout << R"({)" << '\n'
+              << R"(    "suite": )" << '"' << suite_path << '"' << ",\n"
+              << R"(    "generator": )" << '"' << (generator == perft_generator::legal ? "legal" : "pseudo-legal") << '"' << ",\n"
+              << R"(    "strategy": )" << '"' << (strategy == perft_strategy::bulk_count ? "bulk-count" : "make-unmake") << '"' << ",\n"
+              << R"(    "verify": )" << std::boolalpha << verify << std::noboolalpha << ",\n"
+              << R"(    "threads": )" << threads << ",\n"
+              << R"(    "hash-table MB": )" << '"' << get_perft_hash_table_bytes()/1000000 << '"' << ",\n"
+              << R"(    "positions": [)" << '\n';
+
+    std::size_t passed {};
+    std::size_t total_nodes {};
+    for (std::size_t i = 0; i < suite.size(); i++)
+    {
+        const auto& result { results[i] };
+
+        std::size_t nodes {};
+        double duration {};
+        for (const auto& r : result.depths)
+        {
+            nodes += r.nodes;
+            duration += r.duration;
+        }
+
+        passed += result.passed();
+        total_nodes += nodes;
+
+        std::cout << R"(        {)" << '\n'
+                  << R"(            "fen": )" << '"' << suite[i].fen << '"' << ",\n"
+                  << R"(            "depths": [)" << '\n';
+        for (std::size_t j = 0; j < result.depths.size(); j++)
+        {
+            const auto& r { result.depths[j] };
+            std::cout << R"(                { "depth": )" << r.depth
+                      << R"(, "expected": )" << r.expected
+                      << R"(, "nodes": )" << r.nodes
+                      << R"(, "time-ms": )" << static_cast<int>(1000.0 * r.duration)
+                      << R"(, "nps": )" << get_nps(r.nodes, r.duration) << " }"
+                      << (j+1 < result.depths.size() ? ",\n" : "\n");
+        }
+        std::cout << R"(            ],)" << '\n';
+        if (!result.error.empty())
+            std::cout << R"(            "error": )" << '"' << result.error << '"' << ",\n";
+        std::cout << R"(            "passed": )" << std::boolalpha << result.passed() << std::noboolalpha << ",\n"
+                  << R"(            "time-ms": )" << static_cast<int>(1000.0 * duration) << ",\n"
+                  << R"(            "nps": )" << get_nps(nodes, duration) << ",\n"
+                  << R"(            "total-nodes": )" << nodes << '\n'
+                  << R"(        })" << (i+1 < suite.size() ? ",\n" : "\n");
+    }
+
+    const double duration = std::chrono::duration<double>(time_end - time_start).count();
+    std::cout << R"(    ],)" << '\n'
+              << R"(    "passed": )" << passed << ",\n"
+              << R"(    "failed": )" << suite.size() - passed << ",\n"
+              << R"(    "time-ms": )" << static_cast<int>(1000.0 * duration) << ",\n"
+              << R"(    "nps": )" << get_nps(total_nodes, duration) << ",\n"
+              << R"(    "total-nodes": )" << total_nodes << '\n'
+              << R"(})" << '\n';
+
+    return passed == suite.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
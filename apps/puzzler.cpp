@@ -99,7 +99,7 @@ int main(int argc, char** argv)
 
     // Create our puzzle solver and allocate the right amount of memory for the transposition table.
     solver s;
-    s.gs.tt.set_table_bytes(hash_table_size_bytes);
+    s.gs.tt->set_table_bytes(hash_table_size_bytes);
 
     std::size_t puzzles_total {};
     std::size_t puzzles_solved {};
@@ -125,7 +125,7 @@ int main(int argc, char** argv)
               << R"(    "file": )"   << csv_path.filename() << ",\n"
               << R"(    "config": )"; config::print_json(std::cout); std::cout << ",\n"
               << R"(    "depth": )" << depth << ",\n"
-              << R"(    "hash-table MB": )" << '"' << s.gs.tt.get_table_bytes()/1000000 << '"' << ",\n"
+              << R"(    "hash-table MB": )" << '"' << s.gs.tt->get_table_bytes()/1000000 << '"' << ",\n"
               << R"(    "time-ms": )" << std::chrono::duration_cast<std::chrono::milliseconds>(time_end-time_start).count() << ",\n"
               << R"(    "puzzles-total": )" << puzzles_total << ",\n"
               << R"(    "puzzles-solved": )" << puzzles_solved << ",\n"
@@ -0,0 +1,182 @@
+#include "evaluation/tuning.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+std::ostream& print_usage(const char* argv0, std::ostream& os)
+{
+    return os << "Usage: " << argv0 << " <options>\n"
+              << "    Options:\n"
+              << "         -h                   -> Print this help menu.\n"
+              << "         -i [dataset]         -> A file of labelled positions (EPD with c9 results, FEN with [result] or CSV). Can be given multiple times.\n"
+              << "         -o [header]          -> The evaluation parameters header to write. Optional, default parameters.hpp.\n"
+              << "         -e [epochs]          -> The number of passes over the dataset. Optional, default 500.\n"
+              << "         -l [learning rate]   -> The learning rate (in centipawns). Optional, default 1.\n"
+              << "         -s [scale]           -> The scaling constant of the sigmoid. Optional, fitted to the dataset by default.\n"
+              << "         -j [threads]         -> The number of threads. Optional, defaults to the number of hardware threads.\n";
+}
+
+double get_seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    // Default arguments.
+    bool help                      { false };
+    std::vector<std::string> paths;
+    std::string output             { "parameters.hpp" };
+    std::size_t epochs             { 500 };
+    double learning_rate           { 1.0 };
+    double k                       { 0.0 };
+    std::size_t threads            { std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+
+    // Parse options.
+    for (int c; (c = getopt(argc, argv, "hi:o:e:l:s:j:")) != -1; )
+    {
+        switch (c)
+        {
+            // Help.
+            case 'h':
+            {
+                help = true;
+                break;
+            }
+            // Dataset.
+            case 'i':
+            {
+                paths.emplace_back(optarg);
+                break;
+            }
+            // Output header.
+            case 'o':
+            {
+                output = optarg;
+                break;
+            }
+            // Epochs.
+            case 'e':
+            {
+                epochs = std::stoull(optarg);
+                break;
+            }
+            // Learning rate.
+            case 'l':
+            {
+                learning_rate = std::stod(optarg);
+                break;
+            }
+            // Sigmoid scale.
+            case 's':
+            {
+                k = std::stod(optarg);
+                break;
+            }
+            // Threads.
+            case 'j':
+            {
+                threads = std::max(std::stoull(optarg), 1ULL);
+                break;
+            }
+            default:
+                std::cerr << "Could not parse commandline arguments.\n";
+                print_usage(argv[0], std::cerr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    // Just print usage menu and return if we asked for help.
+    if (help)
+    {
+        print_usage(argv[0], std::cout);
+        return EXIT_SUCCESS;
+    }
+
+    if (paths.empty())
+    {
+        std::cerr << "At least one dataset is required.\n";
+        print_usage(argv[0], std::cerr);
+        return EXIT_FAILURE;
+    }
+
+    using namespace evaluation::tuning;
+
+    // Load all the positions, packing them down to their features as we go.
+    const auto load_start { std::chrono::steady_clock::now() };
+    dataset data;
+    for (const auto& path : paths)
+    {
+        std::size_t skipped;
+        const dataset part { load_dataset(path, threads, skipped) };
+        data.append(part);
+
+        std::cout << "loaded " << part.size() << " positions from " << path;
+        if (skipped)
+            std::cout << " (skipped " << skipped << " unparsable lines)";
+        std::cout << '\n';
+    }
+
+    if (data.size() == 0)
+    {
+        std::cerr << "No positions to tune against.\n";
+        return EXIT_FAILURE;
+    }
+
+    const std::size_t bytes { data.features.size()*sizeof(feature) + data.offsets.size()*sizeof(std::size_t) + data.phases.size() + data.results.size() };
+    std::cout << std::fixed << std::setprecision(2)
+              << "dataset " << data.size() << " positions"
+              << " features-per-position " << static_cast<double>(data.features.size())/data.size()
+              << " MB " << bytes/1000000.0
+              << " load-s " << get_seconds_since(load_start) << '\n';
+
+    // Start from the weights we were compiled with, fitting the sigmoid to them if we weren't given a scale.
+    weights w { get_default_weights() };
+    if (k == 0.0)
+    {
+        k = find_k(data, w, threads);
+        std::cout << std::setprecision(4) << "fitted scale " << k << '\n';
+    }
+
+    const auto tune_start { std::chrono::steady_clock::now() };
+    std::cout << std::setprecision(6) << "epoch 0 error " << get_error(data, w, k, threads) << '\n';
+
+    optimiser opt { learning_rate };
+    weights gradient;
+    for (std::size_t epoch = 1; epoch <= epochs; epoch++)
+    {
+        const double error { get_error(data, w, k, threads, &gradient) };
+        opt.step(w, gradient);
+
+        // Note that the error printed is from before this epoch's step.
+        if (epoch % 10 == 0 || epoch == epochs)
+            std::cout << std::setprecision(6) << "epoch " << epoch << " error " << error
+                      << std::setprecision(2) << " s-per-epoch " << get_seconds_since(tune_start)/epoch << std::endl;
+    }
+
+    std::cout << std::setprecision(6) << "final error " << get_error(data, w, k, threads) << '\n';
+
+    std::ofstream ofs(output);
+    write_header(ofs, w);
+    if (!ofs)
+    {
+        std::cerr << "Unable to write " << output << ".\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "wrote " << output << '\n';
+
+    return EXIT_SUCCESS;
+}
@@ -2,22 +2,82 @@
 #include "utility/game.hpp"
 #include "utility/uci.hpp"
 #include "utility/logging.hpp"
+#include "position/generate_moves.hpp"
 #include "position/make_move.hpp"
+#include "position/move.hpp"
+#include "search/time_manager.hpp"
+#include "details/table_memory.hpp"
 #include "version.hpp"
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <sstream>
+#include <variant>
 
 namespace
 {
 
 // Default argument values.
 constexpr std::size_t TRANSPOSITION_TABLE_MB_DEFAULT { 128 };
+constexpr std::size_t EVAL_CACHE_MB_DEFAULT          { game_state::EVAL_CACHE_BYTES_DEFAULT/1000000 };
+constexpr std::size_t THREADS_DEFAULT                { 1 };
+constexpr std::size_t THREADS_MAX                    { 256 };
+
+// The transposition table size last requested - the table itself may still be being resized in the background.
+std::size_t hash_bytes_requested { 0 };
+
+// Reports the size of our transposition table and how it ended up being allocated.
+void print_hash_info(const game& g)
+{
+    const auto& memory { g.gs.tt->get_table_memory() };
+
+    uci::command_info resp;
+    resp.info = "string hash-table " + std::to_string(g.gs.tt->get_table_bytes()/1000000) + " MB"
+              + " pages " + std::string(details::to_string(memory.get_page_type()))
+              + " numa " + std::string(details::to_string(memory.get_numa_policy()));
+    resp.print(std::cout);
+}
+
+// Resizes one of our tables, going back to its old size (or the default if it hasn't been allocated yet) if we can't allocate
+// the new one, e.g. a Hash bigger than the machine's memory, rather than being left without a table. The failure is only
+// reported, so that the GUI carries on.
+template <typename Table>
+void resize_table(Table& table, std::string_view name, std::size_t bytes, std::size_t default_bytes)
+{
+    const std::size_t previous_bytes { table.get_table_bytes() ? table.get_table_bytes() : default_bytes };
+    try
+    {
+        table.set_table_bytes(bytes);
+    }
+    catch (const std::exception& e)
+    {
+        uci::command_info resp;
+        resp.info = "string failed to allocate " + std::to_string(bytes/1000000) + " MB " + std::string(name) + " (" + e.what() + ")"
+                  + ", keeping " + std::to_string(previous_bytes/1000000) + " MB";
+        resp.print(std::cout);
+
+        table.set_table_bytes(previous_bytes);
+    }
+}
+
+// (Re-)allocates our transposition table with the current page and NUMA policies. This is done in the background as it
+// can take seconds for huge tables.
+void set_hash_bytes(game& g, std::size_t bytes)
+{
+    hash_bytes_requested = bytes;
+    g.queue_table_work([&g, bytes] ()
+    {
+        resize_table(*g.gs.tt, "hash-table", bytes, 1000000ULL*TRANSPOSITION_TABLE_MB_DEFAULT);
+        print_hash_info(g);
+    });
+}
 
 void handle(game& /*g*/, const uci::command_uci& /*req*/)
 {
@@ -57,6 +117,43 @@ void handle(game& /*g*/, const uci::command_uci& /*req*/)
         resp.option = "name Hash type spin default " + std::to_string(TRANSPOSITION_TABLE_MB_DEFAULT) + " min 1 max 2048";
         resp.print(std::cout);
     }
+    {
+        uci::command_option resp;
+        resp.option = "name EvalCache type spin default " + std::to_string(EVAL_CACHE_MB_DEFAULT) + " min 1 max 1024";
+        resp.print(std::cout);
+    }
+    {
+        uci::command_option resp;
+        resp.option = "name EvalFile type string default <empty>";
+        resp.print(std::cout);
+    }
+    {
+        uci::command_option resp;
+        resp.option = "name Threads type spin default " + std::to_string(THREADS_DEFAULT) + " min 1 max " + std::to_string(THREADS_MAX);
+        resp.print(std::cout);
+    }
+    {
+        uci::command_option resp;
+        resp.option = "name LargePages type combo default Transparent var Off var Transparent var Explicit";
+        resp.print(std::cout);
+    }
+    {
+        uci::command_option resp;
+        resp.option = "name NumaPolicy type combo default None var None var Interleave var Bind";
+        resp.print(std::cout);
+    }
+
+    // Print the search parameters we can set at runtime (only in tunable builds).
+    for (const auto& p : config::tunable_parameters)
+    {
+        uci::command_option resp;
+        if (const auto value = std::get_if<bool*>(&p.value))
+            resp.option = "name " + std::string(p.name) + " type check default " + (**value ? "true" : "false");
+        else
+            resp.option = "name " + std::string(p.name) + " type spin default " + std::to_string(*std::get<int*>(p.value))
+                        + " min " + std::to_string(p.min) + " max " + std::to_string(p.max);
+        resp.print(std::cout);
+    }
 
     // Says we are ready to start.
     uci::command_uciok{}.print(std::cout);
@@ -65,17 +162,18 @@ void handle(game& /*g*/, const uci::command_uci& /*req*/)
 void handle(game& g, const uci::command_isready& /*req*/)
 {
     // If we haven't already initialised our transposition table, we do it here with the default 128 MB.
-    if (g.gs.tt.get_table_bytes() == 0)
-        g.gs.tt.set_table_bytes(1000000ULL*TRANSPOSITION_TABLE_MB_DEFAULT);
+    if (hash_bytes_requested == 0)
+        set_hash_bytes(g, 1000000ULL*TRANSPOSITION_TABLE_MB_DEFAULT);
 
-    // Say we are ready.
-    uci::command_readyok{}.print(std::cout);
+    // Say we are ready, but only once any table work queued before this is done.
+    g.queue_after_table_work([] () { uci::command_readyok{}.print(std::cout); });
 }
 
 void handle(game& g, const uci::command_ucinewgame& /*req*/)
 {
-    // Reset the game state.
+    // Reset the game state and clear the transposition table in the background.
     g.gs.reset();
+    g.queue_table_work([&g] () { g.gs.tt->clear(); });
 }
 
 void handle(game& g, const uci::command_setoption& req)
@@ -88,7 +186,89 @@ void handle(game& g, const uci::command_setoption& req)
         const std::size_t hash_bytes { 1000000ULL * std::stoull(*req.value) };
 
         // This should only affect the search hash-table.
-        g.gs.tt.set_table_bytes(hash_bytes);
+        set_hash_bytes(g, hash_bytes);
+    }
+    else if (req.name == "EvalCache")
+    {
+        if (!req.value.has_value())
+            throw std::runtime_error("Set eval cache option must contain a value");
+
+        // Like the transposition table, this is resized in the background.
+        const std::size_t eval_cache_bytes { 1000000ULL * std::clamp<std::size_t>(std::stoull(*req.value), 1, 1024) };
+        g.queue_table_work([&g, eval_cache_bytes] () { resize_table(*g.gs.eval_cache, "eval cache", eval_cache_bytes, game_state::EVAL_CACHE_BYTES_DEFAULT); });
+    }
+    else if (req.name == "EvalFile")
+    {
+        // No file goes back to the hand-crafted evaluation. A bad file isn't fatal either - we just report it and keep
+        // using whatever evaluation we had.
+        if (!req.value.has_value() || req.value->empty() || *req.value == "<empty>")
+            g.gs.set_nnue(nullptr);
+        else
+        {
+            uci::command_info resp;
+            try
+            {
+                g.gs.set_nnue(evaluation::nnue::network::load(*req.value));
+                resp.info = "string nnue " + *req.value;
+            }
+            catch (const std::runtime_error& e)
+            {
+                resp.info = "string " + std::string(e.what());
+            }
+            resp.print(std::cout);
+        }
+
+        // Any cached evaluations may have come from the other evaluation function.
+        g.queue_table_work([&g] () { g.gs.eval_cache->clear(); });
+    }
+    else if (req.name == "LargePages" || req.name == "NumaPolicy")
+    {
+        if (!req.value.has_value())
+            throw std::runtime_error("Set " + req.name + " option must contain a value");
+
+        if (req.name == "LargePages")
+        {
+            if (*req.value == "Off")
+                details::set_page_type(details::page_type::normal);
+            else if (*req.value == "Transparent")
+                details::set_page_type(details::page_type::transparent);
+            else if (*req.value == "Explicit")
+                details::set_page_type(details::page_type::hugetlb);
+            else
+                throw std::runtime_error("Unknown LargePages value " + *req.value);
+        }
+        else
+        {
+            if (*req.value == "None")
+                details::set_numa_policy(details::numa_policy::none);
+            else if (*req.value == "Interleave")
+                details::set_numa_policy(details::numa_policy::interleave);
+            else if (*req.value == "Bind")
+                details::set_numa_policy(details::numa_policy::bind);
+            else
+                throw std::runtime_error("Unknown NumaPolicy value " + *req.value);
+        }
+
+        // Re-allocate the table with the new policy if we've already allocated it.
+        if (hash_bytes_requested)
+            set_hash_bytes(g, hash_bytes_requested);
+    }
+    else if (req.name == "Threads")
+    {
+        if (!req.value.has_value())
+            throw std::runtime_error("Set threads option must contain a value");
+
+        g.threads = std::clamp<std::size_t>(std::stoull(*req.value), 1, THREADS_MAX);
+    }
+    else if (const auto p = std::ranges::find(config::tunable_parameters, req.name, &config::tunable_parameter::name); p != config::tunable_parameters.end())
+    {
+        if (!req.value.has_value())
+            throw std::runtime_error("Set " + req.name + " option must contain a value");
+
+        if (const auto value = std::get_if<bool*>(&p->value))
+            **value = *req.value == "true";
+        else
+            *std::get<int*>(p->value) = std::clamp(std::stoi(*req.value), p->min, p->max);
     }
     else
     {
@@ -105,6 +285,9 @@ void handle(game& /*g*/, const uci::command_debug& req)
 
 void handle(game& g, const uci::command_position& req)
 {
+    // Making moves prefetches from our tables, so any table work (which might be reallocating them) has to be done first.
+    g.wait_table_work();
+
     // We use copy-assignment of the position only so we don't clear othe meta-data that affects search (e.g. hash-age).
     g.gs.load(req.bb);
 
@@ -119,25 +302,53 @@ void handle(game& g, const uci::command_position& req)
 void handle(game& g, const uci::command_go& req)
 {
     const bool is_black_to_play { g.gs.bb.is_black_to_play() };
-    if (is_black_to_play ? !req.btime.has_value() : !req.wtime.has_value())
+
+    search::limits limits;
+    if (req.depth)
+        limits.depth = std::min<std::size_t>(*req.depth, limits.depth);
+    if (req.nodes)
+        limits.nodes = *req.nodes;
+    if (req.mate)
+        limits.mate = *req.mate;
+
+    // Restrict the root to the legal moves out of the ones we've been given (if any).
+    if (!req.searchmoves.empty())
     {
-        // Calculate infinitely if we haven't been told our time parameters.
-        g.search(game::search_go, 64);
+        std::array<std::uint32_t, MAX_MOVES_PER_POSITION> move_buf;
+        const std::size_t moves { generate_legal_moves(g.gs.bb, std::span<std::uint32_t>(move_buf)) };
+        for (std::size_t i = 0; i < moves; i++)
+            if (std::find(req.searchmoves.begin(), req.searchmoves.end(), move::to_algebraic_long(move_buf[i])) != req.searchmoves.end())
+                limits.root_moves.push_back(move_buf[i]);
     }
-    else
+
+    if (req.infinite)
+    {
+        // Calculate until we're told to stop.
+        g.search(game::search_go, limits);
+    }
+    else if (req.movetime)
     {
-        // Otherwise, we just spend 1/20 of our remaining time and half our increment calculating this.
-        const std::size_t remaining_ms { is_black_to_play ? *req.btime : *req.wtime };
-        const std::size_t increment_ms { req.get_increment_ms(is_black_to_play) };
+        // Calculate for exactly the time we're given (unless we run out of iterations).
+        g.search(game::search_go, limits, search::time_manager::fixed(std::chrono::milliseconds(*req.movetime)));
+    }
+    else if (is_black_to_play ? req.btime.has_value() : req.wtime.has_value())
+    {
+        // Otherwise the time manager decides how long to spend from our clock.
+        const std::chrono::milliseconds remaining(is_black_to_play ? *req.btime : *req.wtime);
+        const std::chrono::milliseconds increment(req.get_increment_ms(is_black_to_play));
 
-        const std::chrono::milliseconds time((remaining_ms/20) + (increment_ms/2));
-        g.search(game::search_go, 64, time);
+        g.search(game::search_go, limits, search::time_manager::from_clock(remaining, increment, req.movestogo));
+    }
+    else
+    {
+        // Calculate infinitely (or up to the other limits) if we haven't been told our time parameters.
+        g.search(game::search_go, limits);
     }
 }
 
 void handle(game& g, const uci::command_evaluate& req)
 {
-    g.search(game::search_evaluate, req.depth);
+    g.search(game::search_evaluate, { .depth=req.depth });
 }
 
 void handle(game& g, const uci::command_stop& /*req*/)
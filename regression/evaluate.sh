@@ -10,7 +10,8 @@ EVALUATE_PATH="${SCRIPT_DIR}"/../build/apps/waychess-evaluate
 EVALUATE_FEN=$1
 EVALUATE_DEPTH=$2
 EVALUATE_HASH_BYTES=$3
-EVALUATE_RESULT=$("${EVALUATE_PATH}" -f "${EVALUATE_FEN}" -d ${EVALUATE_DEPTH} -k ${EVALUATE_HASH_BYTES})
+EVALUATE_THREADS=${5:-1}
+EVALUATE_RESULT=$("${EVALUATE_PATH}" -f "${EVALUATE_FEN}" -d ${EVALUATE_DEPTH} -k ${EVALUATE_HASH_BYTES} -j ${EVALUATE_THREADS})
 
 # Adds additional metafields to the result and minifies the JSON.
 REGRESSION_HARDWARE=$(lscpu | grep 'Model name' | cut -f 2 -d ":" | awk '{$1=$1}1')
@@ -9,7 +9,16 @@ SCRIPT_DIR="$(dirname "${SCRIPT_PATH}")"
 PERFT_PATH="${SCRIPT_DIR}"/../build/apps/waychess-perft
 PERFT_DEPTH=$1
 PERFT_HASH_BYTES=$2
-PERFT_RESULT=$("${PERFT_PATH}" -d ${PERFT_DEPTH} -k ${PERFT_HASH_BYTES})
+PERFT_THREADS=${4:-1}
+PERFT_STRATEGY=${5:-make-unmake}
+PERFT_FLAGS=()
+if [ "${PERFT_STRATEGY}" == "bulk-count" ]; then
+    PERFT_FLAGS+=(-b)
+elif [ "${PERFT_STRATEGY}" != "make-unmake" ]; then
+    echo "Unknown perft strategy ${PERFT_STRATEGY} (expected make-unmake or bulk-count)." >&2
+    exit 1
+fi
+PERFT_RESULT=$("${PERFT_PATH}" -d ${PERFT_DEPTH} -k ${PERFT_HASH_BYTES} -j ${PERFT_THREADS} "${PERFT_FLAGS[@]}")
 
 # Adds additional metafields to the result and minifies the JSON.
 REGRESSION_HARDWARE=$(lscpu | grep 'Model name' | cut -f 2 -d ":" | awk '{$1=$1}1')
@@ -0,0 +1,36 @@
+#!/bin/bash
+
+set -euo pipefail
+
+SCRIPT_PATH="${BASH_SOURCE:-$0}"
+SCRIPT_DIR="$(dirname "${SCRIPT_PATH}")"
+
+# Runs the command - note that this fails (and so records nothing) if any of the node counts are wrong.
+PERFT_SUITE_PATH="${SCRIPT_DIR}"/../build/apps/waychess-perft-suite
+PERFT_SUITE_EPD="${SCRIPT_DIR}"/perft_suite.epd
+PERFT_SUITE_THREADS=${2:-1}
+PERFT_SUITE_STRATEGY=${3:-make-unmake}
+PERFT_SUITE_FLAGS=()
+if [ "${PERFT_SUITE_STRATEGY}" == "bulk-count" ]; then
+    PERFT_SUITE_FLAGS+=(-b)
+elif [ "${PERFT_SUITE_STRATEGY}" != "make-unmake" ]; then
+    echo "Unknown perft strategy ${PERFT_SUITE_STRATEGY} (expected make-unmake or bulk-count)." >&2
+    exit 1
+fi
+PERFT_SUITE_RESULT=$("${PERFT_SUITE_PATH}" -e "${PERFT_SUITE_EPD}" -j ${PERFT_SUITE_THREADS} "${PERFT_SUITE_FLAGS[@]}")
+
+# Adds additional metafields to the result and minifies the JSON.
+REGRESSION_HARDWARE=$(lscpu | grep 'Model name' | cut -f 2 -d ":" | awk '{$1=$1}1')
+REGRESSION_TIMESTAMP=$(date +%s)
+REGRESSION_GIT=$(git rev-parse HEAD)
+REGRESSION_LABEL=$1
+REGRESSION_RESULT=$(echo ${PERFT_SUITE_RESULT} | jq -c \
+    --arg regression_hardware  "${REGRESSION_HARDWARE}" \
+    --arg regression_timestamp "${REGRESSION_TIMESTAMP}" \
+    --arg regression_git       "${REGRESSION_GIT}"       \
+    --arg regression_label     "${REGRESSION_LABEL}"     \
+    '. += {"hardware": $regression_hardware, "timestamp": $regression_timestamp, "git": $regression_git, "label": $regression_label}')
+
+# Saves the result to the tracking json-lines file.
+REGRESSION_TRACKING_PATH="${SCRIPT_DIR}"/tracking/perft_suite.ndjson
+echo ${REGRESSION_RESULT} >> "${REGRESSION_TRACKING_PATH}"
@@ -25,9 +25,20 @@ for hash_mb in 1 2 5 10 20 50 100 200 500 1000 2000 4000; do
     run "${RUN_PERFT_PATH}" 7 "${hash_mb}" "${SUITE_LABEL}"
 done
 
-# Deep depth-8 perft with fewer hash-sizes.
+# Bulk-counting depth-7 perft, which leaves out make/unmake at the leaves to measure move generation on its own.
+for hash_mb in 0 50 1000; do
+    run "${RUN_PERFT_PATH}" 7 "${hash_mb}" "${SUITE_LABEL}" 1 bulk-count
+done
+
+# Deep depth-8 perft with fewer hash-sizes, split across all of the hardware threads.
 for hash_mb in 50 500 4000; do
-    run "${RUN_PERFT_PATH}" 8 "${hash_mb}" "${SUITE_LABEL}"
+    run "${RUN_PERFT_PATH}" 8 "${hash_mb}" "${SUITE_LABEL}" "$(nproc)"
+done
+
+# The perft suite of positions and their expected node counts, one position per hardware thread.
+RUN_PERFT_SUITE_PATH="${SCRIPT_DIR}"/perft_suite.sh
+for strategy in make-unmake bulk-count; do
+    run "${RUN_PERFT_SUITE_PATH}" "${SUITE_LABEL}" "$(nproc)" "${strategy}"
 done
 
 # ###############################################################################
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <array>
 #include <ios>
 #include <iostream>
+#include <string_view>
+#include <variant>
 
 namespace config
 {
@@ -9,15 +12,73 @@ namespace config
 constexpr bool eval_ks { true };
 constexpr bool eval_ps { true };
 
-constexpr bool nmp   { true };
-constexpr bool lmr   { true };
-constexpr bool km    { true };
-constexpr bool hh    { false };
-constexpr bool see   { true };
-constexpr bool scout { true };
+// The search parameters can be made settable at runtime (as UCI options) by building with WAYCHESS_TUNABLE, so that SPRT
+// tests can try out different values without a rebuild. Otherwise they are constants that get folded into the search.
+#ifdef WAYCHESS_TUNABLE
+#define WAYCHESS_PARAMETER inline
+#else
+#define WAYCHESS_PARAMETER constexpr
+#endif
+
+WAYCHESS_PARAMETER bool nmp   { true };
+WAYCHESS_PARAMETER bool lmr   { true };
+WAYCHESS_PARAMETER bool km    { true };
+WAYCHESS_PARAMETER bool hh    { false };
+WAYCHESS_PARAMETER bool see   { true };
+WAYCHESS_PARAMETER bool scout { true };
+
+// The null-move reduction, which goes up by one above the given depth.
+WAYCHESS_PARAMETER int nmp_reduction       { 3 };
+WAYCHESS_PARAMETER int nmp_reduction_depth { 6 };
+
+// The late-move reduction is base + log(depth)*log(move-number)/divisor, with both constants given in hundredths.
+WAYCHESS_PARAMETER int lmr_base    { 99 };
+WAYCHESS_PARAMETER int lmr_divisor { 314 };
+
+// The quiescence search delta-pruning margin.
+WAYCHESS_PARAMETER int delta_margin { 200 };
+
+// Whether make-move should prefetch the transposition table bucket of the new position.
+constexpr bool tt_prefetch { true };
+
+// Whether the pawn-structure evaluation is cached in the pawn hash table.
+constexpr bool pawn_hash { true };
+
+// Whether quiescence search caches the static evaluation of positions in the evaluation cache.
+constexpr bool eval_cache { true };
 
 // The initial delta of the aspiration window - 0 if we shouldn't use aspiration windows in the search.
-constexpr int awd { 35 };
+WAYCHESS_PARAMETER int awd { 35 };
+
+#undef WAYCHESS_PARAMETER
+
+// The registry of parameters that can be set at runtime (none of them unless built with WAYCHESS_TUNABLE). Switches are given
+// as UCI check options and numeric parameters as UCI spin options between their minimum and maximum.
+struct tunable_parameter
+{
+    std::string_view name;
+    std::variant<bool*, int*> value;
+    int min, max;
+};
+
+#ifdef WAYCHESS_TUNABLE
+inline const std::array tunable_parameters { std::to_array<tunable_parameter>({
+    { "nmp",                 &nmp,                 0, 1    },
+    { "lmr",                 &lmr,                 0, 1    },
+    { "km",                  &km,                  0, 1    },
+    { "hh",                  &hh,                  0, 1    },
+    { "see",                 &see,                 0, 1    },
+    { "scout",               &scout,               0, 1    },
+    { "nmp_reduction",       &nmp_reduction,       1, 6    },
+    { "nmp_reduction_depth", &nmp_reduction_depth, 1, 64   },
+    { "lmr_base",            &lmr_base,            0, 500  },
+    { "lmr_divisor",         &lmr_divisor,         50, 1000 },
+    { "delta_margin",        &delta_margin,        0, 2000 },
+    { "awd",                 &awd,                 0, 1000 }
+}) };
+#else
+inline const std::array<tunable_parameter, 0> tunable_parameters {};
+#endif
 
 inline std::ostream& print_json(std::ostream& os)
 {
@@ -30,7 +91,16 @@ inline std::ostream& print_json(std::ostream& os)
     << R"(    "hh": )"      << std::boolalpha << hh      << std::noboolalpha << ",\n"
     << R"(    "see": )"     << std::boolalpha << see     << std::noboolalpha << ",\n"
     << R"(    "scout": )"   << std::boolalpha << scout   << std::noboolalpha << ",\n"
-    << R"(    "awd": )"     << awd << '\n'
+    << R"(    "tt_prefetch": )" << std::boolalpha << tt_prefetch << std::noboolalpha << ",\n"
+    << R"(    "pawn_hash": )" << std::boolalpha << pawn_hash << std::noboolalpha << ",\n"
+    << R"(    "eval_cache": )" << std::boolalpha << eval_cache << std::noboolalpha << ",\n"
+    << R"(    "nmp_reduction": )" << nmp_reduction << ",\n"
+    << R"(    "nmp_reduction_depth": )" << nmp_reduction_depth << ",\n"
+    << R"(    "lmr_base": )" << lmr_base << ",\n"
+    << R"(    "lmr_divisor": )" << lmr_divisor << ",\n"
+    << R"(    "delta_margin": )" << delta_margin << ",\n"
+    << R"(    "awd": )"     << awd << ",\n"
+    << R"(    "tunable": )" << std::boolalpha << !tunable_parameters.empty() << std::noboolalpha << '\n'
     << R"(})" << '\n';
 }
 
@@ -44,7 +114,16 @@ inline std::ostream& print_tv(std::ostream& os)
               << "hh="      << std::boolalpha << hh      << std::noboolalpha << ','
               << "see="     << std::boolalpha << see     << std::noboolalpha << ','
               << "scout="   << std::boolalpha << scout   << std::noboolalpha << ','
-              << "awd="     << awd;
+              << "tt_prefetch=" << std::boolalpha << tt_prefetch << std::noboolalpha << ','
+              << "pawn_hash=" << std::boolalpha << pawn_hash << std::noboolalpha << ','
+              << "eval_cache=" << std::boolalpha << eval_cache << std::noboolalpha << ','
+              << "nmp_reduction=" << nmp_reduction << ','
+              << "nmp_reduction_depth=" << nmp_reduction_depth << ','
+              << "lmr_base=" << lmr_base << ','
+              << "lmr_divisor=" << lmr_divisor << ','
+              << "delta_margin=" << delta_margin << ','
+              << "awd="     << awd << ','
+              << "tunable=" << std::boolalpha << !tunable_parameters.empty() << std::noboolalpha;
 }
 
 }
\ No newline at end of file
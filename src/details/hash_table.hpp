@@ -1,8 +1,12 @@
 #pragma once
 
-#include <vector>
+#include "details/table_memory.hpp"
+
+#include <span>
+#include <array>
 #include <bit>
 #include <cstdint>
+#include <type_traits>
 
 namespace details
 {
@@ -11,24 +15,40 @@ namespace details
 // DECLARATION
 // ####################################
 
+// A lossy hash table that can be shared between threads without any locking. Each entry is read and written as a series of
+// individual 64-bit words, and we store the key XOR'd with every word of the value. If two threads race writing the same
+// entry, the torn result (words from both writes) then fails the key comparison in exactly the same way that a type-2
+// collision would, so a probe never returns a mixed entry.
 template <typename T>
 class hash_table
 {
 public:
     using key_type = std::uint64_t;
+    using value_type = T;
 
-    // The table also stores the full key so type-2 collisions can be detected (comparison
-    // with original key).
-    struct __attribute__ ((__packed__)) entry_type
-    {
-        using value_type = T;
+    static_assert(std::is_trivially_copyable_v<value_type>, "Hash table values are copied word-by-word");
+    static_assert(sizeof(value_type) % sizeof(std::uint64_t) == 0, "Hash table values must be a whole number of 64-bit words");
+
+    static constexpr std::size_t VALUE_WORDS { sizeof(value_type)/sizeof(std::uint64_t) };
+
+    hash_table() noexcept = default;
+    explicit hash_table(std::size_t bytes) { set_table_bytes(bytes); }
 
+    struct entry_type
+    {
+        // The key XOR'd with each word of the value.
         key_type key;
-        value_type value;
+        std::array<std::uint64_t, VALUE_WORDS> value;
     };
 
-    const entry_type& operator[](std::uint64_t x) const noexcept { return _table[x & _key_mask]; }
-    entry_type& operator[](std::uint64_t x) noexcept { return _table[x & _key_mask]; }
+    // Looks up the key in the table, returning true (and filling in the value) only if we found an intact entry for this key.
+    bool probe(key_type key, value_type& value) const noexcept;
+
+    // Stores the value against the key, always overwriting whatever was there before.
+    void store(key_type key, const value_type& value) noexcept;
+
+    // Starts pulling the entry for the key into cache, so that a probe issued shortly afterwards doesn't stall on memory.
+    void prefetch(key_type key) const noexcept;
 
     // Getters and setters of the table-size in number of entries.
     std::size_t get_table_entries() const noexcept;
@@ -38,15 +58,64 @@ public:
     std::size_t get_table_bytes() const noexcept;
     void set_table_bytes(std::size_t bytes);
 
+    // Clears every entry from the table (in parallel).
+    void clear() noexcept { _memory.clear(); }
+
+    // The memory backing the table, e.g. for reporting what kind of pages we ended up with.
+    const table_memory& get_table_memory() const noexcept { return _memory; }
+
 private:
-    key_type _key_mask;
-    std::vector<entry_type> _table;
+    key_type _key_mask {};
+    table_memory _memory;
+    std::span<entry_type> _table;
 };
 
 // ####################################
 // IMPLEMENTATION
 // ####################################
 
+template <typename T>
+inline bool hash_table<T>::probe(key_type key, value_type& value) const noexcept
+{
+    const entry_type& entry { _table[key & _key_mask] };
+
+    // Relaxed atomic loads are just plain moves on x86, but they stop any individual word from being torn.
+    key_type check { __atomic_load_n(&entry.key, __ATOMIC_RELAXED) };
+    std::array<std::uint64_t, VALUE_WORDS> words;
+    for (std::size_t i = 0; i < VALUE_WORDS; i++)
+    {
+        words[i] = __atomic_load_n(&entry.value[i], __ATOMIC_RELAXED);
+        check ^= words[i];
+    }
+
+    if (check != key)
+        return false;
+
+    value = std::bit_cast<value_type>(words);
+    return true;
+}
+
+template <typename T>
+inline void hash_table<T>::store(key_type key, const value_type& value) noexcept
+{
+    entry_type& entry { _table[key & _key_mask] };
+
+    const auto words { std::bit_cast<std::array<std::uint64_t, VALUE_WORDS>>(value) };
+    for (std::size_t i = 0; i < VALUE_WORDS; i++)
+    {
+        __atomic_store_n(&entry.value[i], words[i], __ATOMIC_RELAXED);
+        key ^= words[i];
+    }
+    __atomic_store_n(&entry.key, key, __ATOMIC_RELAXED);
+}
+
+template <typename T>
+inline void hash_table<T>::prefetch(key_type key) const noexcept
+{
+    // Prefetches never fault, so this is safe even before the table has been allocated.
+    __builtin_prefetch(_table.data() + (key & _key_mask));
+}
+
 template <typename T>
 inline std::size_t hash_table<T>::get_table_entries() const noexcept
 {
@@ -58,9 +127,14 @@ inline void hash_table<T>::set_table_entries(std::size_t entries)
 {
     // We can only allocate the log2-floor of the requested entries because of how our mask works. The use should then
     // call get_table_entries for the true number of entries allocated.
-    _table.resize(std::bit_floor(entries));
-    _table.shrink_to_fit();
-    _key_mask = std::bit_floor(_table.size())-1; 
+    const std::size_t size { std::bit_floor(entries) };
+
+    // Free the old table first so we don't momentarily need the memory for both.
+    _table = {};
+    _memory = {};
+    _memory = table_memory(size*sizeof(entry_type));
+    _table = { static_cast<entry_type*>(_memory.data()), size };
+    _key_mask = size-1;
 }
 
 template <typename T>
@@ -75,4 +149,4 @@ inline void hash_table<T>::set_table_bytes(std::size_t bytes)
     set_table_entries(bytes/sizeof(entry_type));
 }
 
-}
\ No newline at end of file
+}
@@ -8,22 +8,27 @@ namespace details
 struct km_table
 {
     static constexpr std::size_t KM_MOVES { 2 };
-    std::array<std::array<std::uint16_t, KM_MOVES>, pv_table::MAX_DEPTH> table;
 
-    bool is_killer_move(std::size_t ply, std::uint16_t move) const noexcept;
-    void store_killer_move(std::size_t ply, std::uint16_t move) noexcept;
+    // We keep the whole move (without its info bits) so that the search can play killers before generating any moves.
+    std::array<std::array<std::uint32_t, KM_MOVES>, pv_table::MAX_DEPTH> table;
+
+    bool is_killer_move(std::size_t ply, std::uint32_t move) const noexcept;
+    void store_killer_move(std::size_t ply, std::uint32_t move) noexcept;
 
     // Wipe all state from the table - this should only be used when starting a new game.
     void reset() noexcept;
 };
 
-inline bool km_table::is_killer_move(std::size_t ply, std::uint16_t move) const noexcept
+inline bool km_table::is_killer_move(std::size_t ply, std::uint32_t move) const noexcept
 {
+    move &= 0x0fffffff;
     return table[ply][0] == move || table[ply][1] == move;
 }
 
-inline void km_table::store_killer_move(std::size_t ply, std::uint16_t move) noexcept
+inline void km_table::store_killer_move(std::size_t ply, std::uint32_t move) noexcept
 {
+    move &= 0x0fffffff;
+
     // Shift the old killer moves down.
     if (move != table[ply][0])
     {
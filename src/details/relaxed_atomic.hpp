@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+
+namespace details
+{
+
+// A std::atomic with relaxed loads and stores for flags that one thread sets while another polls them (e.g. stopping the
+// search), where nothing else is ordered by the flag. Unlike std::atomic it can be copied (taking the current value), so that
+// the game-state holding it can still be copied for the helper threads.
+template <typename T>
+class relaxed_atomic
+{
+public:
+    constexpr relaxed_atomic(T value = {}) noexcept : _value(value) {}
+
+    relaxed_atomic(const relaxed_atomic& other) noexcept : _value(other.load()) {}
+    relaxed_atomic& operator=(const relaxed_atomic& other) noexcept { store(other.load()); return *this; }
+
+    relaxed_atomic& operator=(T value) noexcept { store(value); return *this; }
+    operator T() const noexcept { return load(); }
+
+    T load() const noexcept { return _value.load(std::memory_order_relaxed); }
+    void store(T value) noexcept { _value.store(value, std::memory_order_relaxed); }
+
+private:
+    std::atomic<T> _value;
+};
+
+}
@@ -0,0 +1,303 @@
+#include "table_memory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <new>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <cstdlib>
+#endif
+
+namespace
+{
+
+constexpr std::size_t HUGE_PAGE_BYTES { 1ULL << 21 };
+
+std::atomic<details::page_type>   page_type_global   { details::page_type::transparent };
+std::atomic<details::numa_policy> numa_policy_global { details::numa_policy::none };
+
+// Below this it isn't worth the cost of spinning up threads to clear a table.
+constexpr std::size_t PARALLEL_CLEAR_BYTES { 1ULL << 24 };
+
+constexpr std::size_t round_up(std::size_t x, std::size_t multiple) noexcept
+{
+    return (x + multiple - 1) / multiple * multiple;
+}
+
+void parallel_zero(void* data, std::size_t bytes) noexcept
+{
+    const std::size_t threads { std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+    if (threads == 1 || bytes < PARALLEL_CLEAR_BYTES)
+    {
+        std::memset(data, 0, bytes);
+        return;
+    }
+
+    // Split on huge-page boundaries so no two threads fault the same page.
+    const std::size_t chunk { round_up(bytes/threads, HUGE_PAGE_BYTES) };
+
+    std::vector<std::thread> workers;
+    for (std::size_t offset = 0; offset < bytes; offset += chunk)
+    {
+        workers.emplace_back([p = static_cast<char*>(data) + offset, n = std::min(chunk, bytes-offset)] ()
+        {
+            std::memset(p, 0, n);
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+#ifdef __linux__
+
+// Enough for 1024 nodes which is far more than we'll ever see.
+using node_mask = std::array<unsigned long, 16>;
+
+void* map_hugetlb(std::size_t bytes) noexcept
+{
+    void* ret = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    return ret == MAP_FAILED ? nullptr : ret;
+}
+
+// The size of a normal page, which everything we map or unmap has to be a multiple of.
+std::size_t get_page_bytes() noexcept
+{
+    static const std::size_t ret { static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) };
+    return ret;
+}
+
+// Transparent huge pages can only back huge-page aligned regions, so we over-map by a huge page and trim either side. The
+// bytes have to be a whole number of pages, otherwise the trailing trim isn't page-aligned and fails (leaking the tail).
+void* map_aligned(std::size_t bytes) noexcept
+{
+    const std::size_t mapped { bytes + HUGE_PAGE_BYTES };
+    void* p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return nullptr;
+
+    const auto start   = reinterpret_cast<std::uintptr_t>(p);
+    const auto aligned = round_up(start, HUGE_PAGE_BYTES);
+    if (aligned > start)
+        munmap(p, aligned - start);
+    if (const std::size_t tail { start + mapped - (aligned + bytes) }; tail)
+        munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+
+    return reinterpret_cast<void*>(aligned);
+}
+
+// Parses the online NUMA nodes from sysfs (e.g. "0-1,3"), returning the number of nodes found.
+std::size_t get_online_nodes(node_mask& mask)
+{
+    mask = {};
+
+    std::ifstream is("/sys/devices/system/node/online");
+    std::string ranges;
+    if (!(is >> ranges))
+        return 0;
+
+    std::size_t nodes {};
+    for (std::size_t pos = 0; pos < ranges.size(); )
+    {
+        const std::size_t end { std::min(ranges.find(',', pos), ranges.size()) };
+        const std::string range { ranges.substr(pos, end-pos) };
+        const std::size_t dash { range.find('-') };
+
+        const std::size_t first { std::stoull(range.substr(0, dash)) };
+        const std::size_t last  { dash == std::string::npos ? first : std::stoull(range.substr(dash+1)) };
+        for (std::size_t node = first; node <= last && node < 8*sizeof(node_mask); node++, nodes++)
+            mask[node/64] |= 1UL << (node%64);
+
+        pos = end+1;
+    }
+
+    return nodes;
+}
+
+// Applies the NUMA policy to the (not yet touched) memory, returning the policy that actually took effect. This is a no-op
+// on single-node machines.
+details::numa_policy apply_numa_policy(void* data, std::size_t bytes, details::numa_policy policy)
+{
+    if (policy == details::numa_policy::none)
+        return policy;
+
+    node_mask mask;
+    if (get_online_nodes(mask) <= 1)
+        return details::numa_policy::none;
+
+    int mode { MPOL_INTERLEAVE };
+    if (policy == details::numa_policy::bind)
+    {
+        unsigned int cpu, node;
+        if (getcpu(&cpu, &node) != 0 || node >= 8*sizeof(node_mask))
+            return details::numa_policy::none;
+
+        mask = {};
+        mask[node/64] |= 1UL << (node%64);
+        mode = MPOL_BIND;
+    }
+
+    // The kernel only considers maxnode-1 bits of the mask.
+    if (syscall(SYS_mbind, data, bytes, mode, mask.data(), 8*sizeof(node_mask), 0) != 0)
+        return details::numa_policy::none;
+
+    return policy;
+}
+
+#endif
+
+}
+
+namespace details
+{
+
+std::string_view to_string(page_type v) noexcept
+{
+    switch (v)
+    {
+        case page_type::normal:      return "normal";
+        case page_type::transparent: return "transparent";
+        case page_type::hugetlb:     return "hugetlb";
+    }
+    return "unknown";
+}
+
+std::string_view to_string(numa_policy v) noexcept
+{
+    switch (v)
+    {
+        case numa_policy::none:       return "none";
+        case numa_policy::interleave: return "interleave";
+        case numa_policy::bind:       return "bind";
+    }
+    return "unknown";
+}
+
+void set_page_type(page_type v) noexcept
+{
+    page_type_global = v;
+}
+
+page_type get_page_type() noexcept
+{
+    return page_type_global;
+}
+
+void set_numa_policy(numa_policy v) noexcept
+{
+    numa_policy_global = v;
+}
+
+numa_policy get_numa_policy() noexcept
+{
+    return numa_policy_global;
+}
+
+table_memory::table_memory(std::size_t bytes)
+    : _bytes(bytes)
+{
+    if (!_bytes)
+        return;
+
+#ifdef __linux__
+    const page_type requested { details::get_page_type() };
+
+    // Explicit huge pages come out of a pool that has to be reserved up-front, so this often fails - in which case we fall
+    // back to trying transparent huge pages.
+    if (requested == page_type::hugetlb)
+    {
+        _mapped_bytes = round_up(_bytes, HUGE_PAGE_BYTES);
+        _data = map_hugetlb(_mapped_bytes);
+        if (_data)
+            _page_type = page_type::hugetlb;
+    }
+
+    if (!_data)
+    {
+        _mapped_bytes = round_up(_bytes, requested == page_type::normal ? get_page_bytes() : HUGE_PAGE_BYTES);
+        _data = map_aligned(_mapped_bytes);
+        if (!_data)
+            throw std::bad_alloc();
+
+        // Explicitly opt out of huge pages when asked for normal pages, so we're still comparing like-for-like on machines
+        // where transparent huge pages are always on.
+        if (requested == page_type::normal)
+            madvise(_data, _mapped_bytes, MADV_NOHUGEPAGE);
+        else if (madvise(_data, _mapped_bytes, MADV_HUGEPAGE) == 0)
+            _page_type = page_type::transparent;
+    }
+
+    // This has to be done before the pages are first touched.
+    _numa_policy = apply_numa_policy(_data, _mapped_bytes, details::get_numa_policy());
+#else
+    _mapped_bytes = round_up(_bytes, 64);
+    _data = std::aligned_alloc(64, _mapped_bytes);
+    if (!_data)
+        throw std::bad_alloc();
+#endif
+
+    // The memory is already zero but we fault all of the pages in now rather than during the search.
+    clear();
+}
+
+void table_memory::clear() noexcept
+{
+    if (_data)
+        parallel_zero(_data, _mapped_bytes);
+}
+
+table_memory::table_memory(table_memory&& v) noexcept
+    : _data(std::exchange(v._data, nullptr))
+    , _bytes(std::exchange(v._bytes, 0))
+    , _mapped_bytes(std::exchange(v._mapped_bytes, 0))
+    , _page_type(v._page_type)
+    , _numa_policy(v._numa_policy)
+{}
+
+table_memory& table_memory::operator=(table_memory&& v) noexcept
+{
+    if (this != &v)
+    {
+        release();
+        _data         = std::exchange(v._data, nullptr);
+        _bytes        = std::exchange(v._bytes, 0);
+        _mapped_bytes = std::exchange(v._mapped_bytes, 0);
+        _page_type    = v._page_type;
+        _numa_policy  = v._numa_policy;
+    }
+    return *this;
+}
+
+table_memory::~table_memory()
+{
+    release();
+}
+
+void table_memory::release() noexcept
+{
+    if (!_data)
+        return;
+
+#ifdef __linux__
+    munmap(_data, _mapped_bytes);
+#else
+    std::free(_data);
+#endif
+
+    _data = nullptr;
+}
+
+}
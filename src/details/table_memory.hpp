@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace details
+{
+
+// ####################################
+// DECLARATION
+// ####################################
+
+// The kind of pages backing one of our large tables. Huge pages massively cut down the TLB misses of random hash-table probes,
+// and the kernel also has far fewer pages to fault in when we first touch the table.
+enum class page_type : std::uint8_t
+{
+    // Regular 4 KiB pages.
+    normal,
+    // 2 MiB transparent huge pages requested through madvise (the kernel may still back some of the table with regular pages).
+    transparent,
+    // 2 MiB pages from the explicitly reserved huge-page pool.
+    hugetlb
+};
+
+// How we spread a table across NUMA nodes.
+enum class numa_policy : std::uint8_t
+{
+    // Leave it up to the kernel (usually first-touch).
+    none,
+    // Interleave the pages across all online nodes - best when search threads are spread across the machine.
+    interleave,
+    // Bind the pages to the node we're allocating from.
+    bind
+};
+
+std::string_view to_string(page_type v) noexcept;
+std::string_view to_string(numa_policy v) noexcept;
+
+// Global allocation policies for any tables allocated after they are set. We always fall back to smaller pages (and to no NUMA
+// policy) if what was asked for isn't available, so the policies of a table should be read back from its memory.
+void set_page_type(page_type v) noexcept;
+page_type get_page_type() noexcept;
+
+void set_numa_policy(numa_policy v) noexcept;
+numa_policy get_numa_policy() noexcept;
+
+// Owner of a zero-initialised (and pre-faulted) block of memory for one of our large tables, allocated according to the
+// global policies.
+class table_memory
+{
+public:
+    table_memory() noexcept = default;
+    explicit table_memory(std::size_t bytes);
+
+    table_memory(const table_memory&) = delete;
+    table_memory& operator=(const table_memory&) = delete;
+
+    table_memory(table_memory&& v) noexcept;
+    table_memory& operator=(table_memory&& v) noexcept;
+
+    ~table_memory();
+
+    void* data() const noexcept { return _data; }
+    std::size_t size() const noexcept { return _bytes; }
+
+    // Zeroes the memory using all our hardware threads. This is also how we first touch the pages when allocating, so the
+    // faulting cost is split between the threads (and the pages land on their nodes under the default NUMA policy).
+    void clear() noexcept;
+
+    // The policies we actually ended up with for this block (after any fall-backs).
+    page_type get_page_type() const noexcept { return _page_type; }
+    numa_policy get_numa_policy() const noexcept { return _numa_policy; }
+
+private:
+    void* _data {};
+    std::size_t _bytes {};
+    std::size_t _mapped_bytes {};
+
+    page_type _page_type { page_type::normal };
+    numa_policy _numa_policy { numa_policy::none };
+
+    void release() noexcept;
+};
+
+}
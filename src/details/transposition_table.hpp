@@ -1,12 +1,26 @@
 #pragma once
 
-#include "details/hash_table.hpp"
+#include "details/table_memory.hpp"
+#include "evaluation/evaluate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
 
 namespace details
 {
 
-// The value type in our hash table for search - we may expand this in the future.
-struct __attribute__ ((__packed__)) search_value_type
+// ####################################
+// DECLARATION
+// ####################################
+
+// The value type in our hash table for search - we may expand this in the future. This is only what we probe and store,
+// the table itself packs it down into a single 64-bit word, with the evaluation narrowed to 16 bits (checkmate scores are
+// kept exactly, other evaluations beyond that range are saturated).
+struct search_value_type
 {
     std::uint8_t age;
     std::uint8_t depth;
@@ -17,7 +31,228 @@ struct __attribute__ ((__packed__)) search_value_type
     std::uint8_t meta;
 };
 
-// We have one global transposition table.
-using transposition_table = ::details::hash_table<search_value_type>;
+// The transposition table for search. Entries are clustered into cache-line aligned buckets so that a probe costs at most
+// one cache-miss, and a collision can evict the least valuable entry in the bucket rather than always the one we hit. The
+// bucket index already accounts for the lower bits of the key, so each entry only keeps the upper 32 bits. Like our other
+// hash tables, entries are lock-free with the key-word stored XOR'd with the data-word so torn writes are seen as misses - as
+// we only keep 32 bits of key, it's XOR'd with both halves of the data-word so that every bit of the data is checked.
+class transposition_table
+{
+public:
+    using key_type = std::uint64_t;
+    using value_type = search_value_type;
+
+    struct entry_type
+    {
+        // The upper 32 bits of the key, XOR'd with both halves of the data-word (the lower 32 bits are unused).
+        std::uint64_t key;
+
+        // The evaluation, depth, age, best move (without its info bits), and meta.
+        std::uint64_t data;
+    };
+
+    static constexpr std::size_t BUCKET_ENTRIES { 4 };
+
+    struct alignas(64) bucket_type
+    {
+        std::array<entry_type, BUCKET_ENTRIES> entries;
+    };
+
+    // Looks up the key in its bucket, returning true (and filling in the value) only if we found an intact entry for this key.
+    bool probe(key_type key, value_type& value) const noexcept;
+
+    // Stores the value against the key. An existing entry for the same key is always overwritten, otherwise we replace the
+    // entry in the bucket with the lowest depth, treating entries from older searches (relative to the age of the value being
+    // stored) as shallower.
+    void store(key_type key, const value_type& value) noexcept;
+
+    // Starts pulling the bucket for the key into cache, so that a probe issued shortly afterwards doesn't stall on memory.
+    void prefetch(key_type key) const noexcept;
+
+    // The permille of entries that have been written during the search of the given age (the UCI "hashfull" info). This only
+    // samples the start of the table.
+    std::size_t get_hashfull(std::uint8_t age) const noexcept;
+
+    // Getters and setters of the table-size in number of entries (rounded down to a whole number of buckets).
+    std::size_t get_table_entries() const noexcept;
+    void set_table_entries(std::size_t entries);
+
+    // Getters and setters of the table-size in bytes.
+    std::size_t get_table_bytes() const noexcept;
+    void set_table_bytes(std::size_t bytes);
+
+    // Clears every entry from the table (in parallel).
+    void clear() noexcept { _memory.clear(); }
+
+    // The memory backing the table, e.g. for reporting what kind of pages we ended up with.
+    const table_memory& get_table_memory() const noexcept { return _memory; }
+
+private:
+    key_type _bucket_mask {};
+    table_memory _memory;
+    std::span<bucket_type> _table;
+
+    // The number of depth-plies each search-age an entry is behind is worth when picking which entry to replace.
+    static constexpr int REPLACE_AGE_WEIGHT { 8 };
+
+    static constexpr std::uint64_t KEY_MASK { 0xffffffff00000000ULL };
+
+    // Evaluations are stored in 16 bits, with the extremes kept for checkmate.
+    static constexpr int EVAL_MATE { std::numeric_limits<std::int16_t>::max() };
+
+    static constexpr std::uint16_t encode_eval(int eval) noexcept;
+    static constexpr int decode_eval(std::uint16_t eval) noexcept;
+
+    // The check stored against the key, folding both halves of the data-word into the upper 32 bits.
+    static constexpr std::uint64_t get_check(std::uint64_t data) noexcept { return (data ^ (data << 32)) & KEY_MASK; }
+
+    static constexpr std::uint8_t get_depth(std::uint64_t data) noexcept { return static_cast<std::uint8_t>(data >> 16); }
+    static constexpr std::uint8_t get_age(std::uint64_t data)   noexcept { return static_cast<std::uint8_t>(data >> 24); }
+    static constexpr int get_replace_worth(std::uint64_t data, std::uint8_t age) noexcept;
+};
+
+// ####################################
+// IMPLEMENTATION
+// ####################################
+
+constexpr std::uint16_t transposition_table::encode_eval(int eval) noexcept
+{
+    if (eval >= evaluation::EVAL_CHECKMATE)
+        return static_cast<std::uint16_t>(EVAL_MATE);
+    if (eval <= -evaluation::EVAL_CHECKMATE)
+        return static_cast<std::uint16_t>(-EVAL_MATE);
+    return static_cast<std::uint16_t>(std::clamp(eval, -EVAL_MATE+1, EVAL_MATE-1));
+}
+
+constexpr int transposition_table::decode_eval(std::uint16_t eval) noexcept
+{
+    const int ret { static_cast<std::int16_t>(eval) };
+    if (ret == EVAL_MATE)
+        return evaluation::EVAL_CHECKMATE;
+    if (ret == -EVAL_MATE)
+        return -evaluation::EVAL_CHECKMATE;
+    return ret;
+}
+
+constexpr int transposition_table::get_replace_worth(std::uint64_t data, std::uint8_t age) noexcept
+{
+    const std::uint8_t age_diff = age - get_age(data);
+    return static_cast<int>(get_depth(data)) - REPLACE_AGE_WEIGHT*static_cast<int>(age_diff);
+}
+
+inline bool transposition_table::probe(key_type key, value_type& value) const noexcept
+{
+    const bucket_type& bucket { _table[key & _bucket_mask] };
+
+    for (const entry_type& entry : bucket.entries)
+    {
+        // Relaxed atomic loads are just plain moves on x86, but they stop either word from being torn.
+        const std::uint64_t data { __atomic_load_n(&entry.data, __ATOMIC_RELAXED) };
+        const std::uint64_t check { __atomic_load_n(&entry.key, __ATOMIC_RELAXED) ^ get_check(data) };
+        if ((check ^ key) & KEY_MASK)
+            continue;
+
+        value.age       = get_age(data);
+        value.depth     = get_depth(data);
+        value.eval      = decode_eval(static_cast<std::uint16_t>(data));
+        value.best_move = static_cast<std::uint32_t>(data >> 32) & 0x0fffffff;
+        value.meta      = static_cast<std::uint8_t>(data >> 60);
+        return true;
+    }
+
+    return false;
+}
+
+inline void transposition_table::store(key_type key, const value_type& value) noexcept
+{
+    bucket_type& bucket { _table[key & _bucket_mask] };
+
+    // Find the entry to replace - either this position's own entry, or the least valuable one in the bucket.
+    entry_type* replace { bucket.entries.data() };
+    int replace_worth { std::numeric_limits<int>::max() };
+    for (entry_type& entry : bucket.entries)
+    {
+        const std::uint64_t data { __atomic_load_n(&entry.data, __ATOMIC_RELAXED) };
+        const std::uint64_t check { __atomic_load_n(&entry.key, __ATOMIC_RELAXED) ^ get_check(data) };
+        if (!((check ^ key) & KEY_MASK))
+        {
+            replace = &entry;
+            break;
+        }
+
+        if (const int worth { get_replace_worth(data, value.age) }; worth < replace_worth)
+        {
+            replace = &entry;
+            replace_worth = worth;
+        }
+    }
+
+    const std::uint64_t data {
+        static_cast<std::uint64_t>(encode_eval(value.eval)) |
+        static_cast<std::uint64_t>(value.depth) << 16 |
+        static_cast<std::uint64_t>(value.age) << 24 |
+        static_cast<std::uint64_t>(value.best_move & 0x0fffffff) << 32 |
+        static_cast<std::uint64_t>(value.meta & 0x0f) << 60
+    };
+
+    __atomic_store_n(&replace->data, data, __ATOMIC_RELAXED);
+    __atomic_store_n(&replace->key, (key & KEY_MASK) ^ get_check(data), __ATOMIC_RELAXED);
+}
+
+inline void transposition_table::prefetch(key_type key) const noexcept
+{
+    // Prefetches never fault, so this is safe even before the table has been allocated.
+    __builtin_prefetch(_table.data() + (key & _bucket_mask));
+}
+
+inline std::size_t transposition_table::get_hashfull(std::uint8_t age) const noexcept
+{
+    const std::size_t buckets { std::min<std::size_t>(_table.size(), 1000/BUCKET_ENTRIES) };
+    if (!buckets)
+        return 0;
+
+    std::size_t used {};
+    for (std::size_t i = 0; i < buckets; i++)
+    {
+        for (const entry_type& entry : _table[i].entries)
+        {
+            const std::uint64_t data { __atomic_load_n(&entry.data, __ATOMIC_RELAXED) };
+            const std::uint64_t key { __atomic_load_n(&entry.key, __ATOMIC_RELAXED) };
+            if ((key || data) && get_age(data) == age)
+                used++;
+        }
+    }
+
+    return 1000*used / (buckets*BUCKET_ENTRIES);
+}
+
+inline std::size_t transposition_table::get_table_entries() const noexcept
+{
+    return _table.size()*BUCKET_ENTRIES;
+}
+
+inline void transposition_table::set_table_entries(std::size_t entries)
+{
+    // Like our other hash tables we can only allocate the log2-floor of the requested buckets because of how our mask works.
+    const std::size_t buckets { std::bit_floor(entries/BUCKET_ENTRIES) };
+
+    // Free the old table first so we don't momentarily need the memory for both. Our memory is always at least page-aligned
+    // so the buckets will be cache-line aligned.
+    _table = {};
+    _memory = {};
+    _memory = table_memory(buckets*sizeof(bucket_type));
+    _table = { static_cast<bucket_type*>(_memory.data()), buckets };
+    _bucket_mask = buckets-1;
+}
+
+inline std::size_t transposition_table::get_table_bytes() const noexcept
+{
+    return _table.size()*sizeof(bucket_type);
+}
+
+inline void transposition_table::set_table_bytes(std::size_t bytes)
+{
+    set_table_entries(BUCKET_ENTRIES*(bytes/sizeof(bucket_type)));
+}
 
-}
\ No newline at end of file
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "evaluation/parameters.hpp"
+
 #include <array>
 
 namespace evaluation
@@ -9,22 +11,12 @@ namespace details
 {
 
 /*********************************************************************
-* PeSTO's raw piece evaluation used in RofChade.                     *
+* PeSTO's raw piece evaluation used in RofChade. The white values    *
+* live in the parameters header generated by waychess-tune           *
+* (currently still the untuned PeSTO values), and black's are just   *
+* their negatives.                                                   *
 *********************************************************************/
 
-constexpr int white_pawn_mg_evaluation   { 82 };
-constexpr int white_pawn_eg_evaluation   { 94 };
-constexpr int white_knight_mg_evaluation { 337 };
-constexpr int white_knight_eg_evaluation { 281 };
-constexpr int white_bishop_mg_evaluation { 365 };
-constexpr int white_bishop_eg_evaluation { 297 };
-constexpr int white_rook_mg_evaluation   { 477 };
-constexpr int white_rook_eg_evaluation   { 512 };
-constexpr int white_queen_mg_evaluation  { 1025 };
-constexpr int white_queen_eg_evaluation  { 936 };
-constexpr int white_king_mg_evaluation   { 10000 };
-constexpr int white_king_eg_evaluation   { 10000 };
-
 constexpr int black_pawn_mg_evaluation   { -white_pawn_mg_evaluation };
 constexpr int black_pawn_eg_evaluation   { -white_pawn_eg_evaluation };
 constexpr int black_knight_mg_evaluation { -white_knight_mg_evaluation };
@@ -1,47 +1,44 @@
 #pragma once
 
+#include "evaluation/game_phase.hpp"
+#include "evaluation/parameters.hpp"
 #include "pieces/pieces.hpp"
 #include "position/bitboard.hpp"
 
 namespace evaluation
 {
 
-namespace details
+// The pawn-structure terms that only depend on the pawns themselves (so can be cached against the pawn hash).
+inline phased_eval evaluate_pawn_structure_pawns(const bitboard& bb)
 {
+    const int isolated { std::popcount(get_pawn_isolated(bb.boards[b_pawn])) - std::popcount(get_pawn_isolated(bb.boards[w_pawn])) };
+    const int doubled  { std::popcount(get_pawn_doubled(bb.boards[b_pawn]))  - std::popcount(get_pawn_doubled(bb.boards[w_pawn]))  };
 
-constexpr int isolated_pawns_penalty_mg { 10 };
-constexpr int isolated_pawns_penalty_eg { 15 };
-
-constexpr int doubled_pawns_penalty_mg { 8 };
-constexpr int doubled_pawns_penalty_eg { 15 };
-
-constexpr int blocked_pawns_penalty_mg { 12 };
-constexpr int blocked_pawns_penalty_eg { 10 };
-
+    return {
+        .mg = isolated * details::isolated_pawns_penalty_mg + doubled * details::doubled_pawns_penalty_mg,
+        .eg = isolated * details::isolated_pawns_penalty_eg + doubled * details::doubled_pawns_penalty_eg
+    };
 }
 
-inline int evaluate_pawn_structure_mg(const bitboard& bb)
+// The pawn-structure terms that also depend on the other pieces.
+inline phased_eval evaluate_pawn_structure_pieces(const bitboard& bb)
 {
     const std::uint64_t occ { bb.boards[piece_idx::w_any] | bb.boards[piece_idx::b_any] };
 
-    return std::popcount(get_pawn_isolated(bb.boards[b_pawn]))           * details::isolated_pawns_penalty_mg
-         + std::popcount(get_pawn_doubled(bb.boards[b_pawn]))            * details::doubled_pawns_penalty_mg
-         + std::popcount(get_black_pawn_blocked(bb.boards[b_pawn], occ)) * details::blocked_pawns_penalty_mg
-         - std::popcount(get_pawn_isolated(bb.boards[w_pawn]))           * details::isolated_pawns_penalty_mg
-         - std::popcount(get_pawn_doubled(bb.boards[w_pawn]))            * details::doubled_pawns_penalty_mg
-         - std::popcount(get_white_pawn_blocked(bb.boards[w_pawn], occ)) * details::blocked_pawns_penalty_mg;
+    const int blocked { std::popcount(get_black_pawn_blocked(bb.boards[b_pawn], occ)) - std::popcount(get_white_pawn_blocked(bb.boards[w_pawn], occ)) };
+
+    return {
+        .mg = blocked * details::blocked_pawns_penalty_mg,
+        .eg = blocked * details::blocked_pawns_penalty_eg
+    };
 }
 
-inline int evaluate_pawn_structure_eg(const bitboard& bb)
+inline phased_eval evaluate_pawn_structure(const bitboard& bb)
 {
-    const std::uint64_t occ { bb.boards[piece_idx::w_any] | bb.boards[piece_idx::b_any] };
-
-    return std::popcount(get_pawn_isolated(bb.boards[b_pawn]))           * details::isolated_pawns_penalty_eg
-         + std::popcount(get_pawn_doubled(bb.boards[b_pawn]))            * details::doubled_pawns_penalty_eg
-         + std::popcount(get_black_pawn_blocked(bb.boards[b_pawn], occ)) * details::blocked_pawns_penalty_eg
-         - std::popcount(get_pawn_isolated(bb.boards[w_pawn]))           * details::isolated_pawns_penalty_eg
-         - std::popcount(get_pawn_doubled(bb.boards[w_pawn]))            * details::doubled_pawns_penalty_eg
-         - std::popcount(get_white_pawn_blocked(bb.boards[w_pawn], occ)) * details::blocked_pawns_penalty_eg;
+    return evaluate_pawn_structure_pawns(bb) + evaluate_pawn_structure_pieces(bb);
 }
 
-}
\ No newline at end of file
+inline int evaluate_pawn_structure_mg(const bitboard& bb) { return evaluate_pawn_structure(bb).mg; }
+inline int evaluate_pawn_structure_eg(const bitboard& bb) { return evaluate_pawn_structure(bb).eg; }
+
+}
@@ -54,6 +54,21 @@ constexpr int evaluate_gp(const bitboard& bb) noexcept
     return ret;
 }
 
+// A pair of middle-game and end-game scores. Evaluation terms produce both of these in a single pass, and they are summed up
+// before interpolating just once for the whole evaluation.
+struct phased_eval
+{
+    int mg, eg;
+
+    constexpr phased_eval& operator+=(const phased_eval& other) noexcept { mg += other.mg; eg += other.eg; return *this; }
+    constexpr phased_eval& operator-=(const phased_eval& other) noexcept { mg -= other.mg; eg -= other.eg; return *this; }
+
+    constexpr phased_eval operator+(const phased_eval& other) const noexcept { return phased_eval(*this) += other; }
+    constexpr phased_eval operator-(const phased_eval& other) const noexcept { return phased_eval(*this) -= other; }
+
+    constexpr bool operator==(const phased_eval& other) const noexcept = default;
+};
+
 // Interpolates between a middle-game and end-game score.
 constexpr int interpolate_gp(int mg, int eg, int gp) noexcept
 {
@@ -64,14 +79,24 @@ constexpr int interpolate_gp(int mg, int eg, int gp) noexcept
     return (mg*gp + eg*(24-gp))/24;
 }
 
+constexpr int interpolate_gp(const phased_eval& eval, int gp) noexcept
+{
+    return interpolate_gp(eval.mg, eval.eg, gp);
+}
+
+// The game phase is kept incrementally up to date in the search, so these should be given that rather than the bitboard where
+// possible.
+constexpr bool is_endgame(int gp)      noexcept { return gp < 8; }
+constexpr bool is_late_endgame(int gp) noexcept { return gp < 6; }
+
 constexpr bool is_endgame(const bitboard& bb) noexcept
 {
-    return evaluate_gp(bb) < 8;
+    return is_endgame(evaluate_gp(bb));
 }
 
 constexpr bool is_late_endgame(const bitboard& bb) noexcept
 {
-    return evaluate_gp(bb) < 6;
+    return is_late_endgame(evaluate_gp(bb));
 }
 
 }
\ No newline at end of file
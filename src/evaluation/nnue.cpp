@@ -0,0 +1,34 @@
+#include "nnue.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace evaluation::nnue
+{
+
+std::shared_ptr<network> network::load(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs)
+        throw std::runtime_error("Unable to open network file " + path);
+
+    // We only support the one network architecture, so anything else must be the wrong file.
+    std::error_code ec;
+    const auto file_bytes { std::filesystem::file_size(path, ec) };
+    if (ec || file_bytes != FILE_BYTES)
+        throw std::runtime_error("Network file " + path + " is not " + std::to_string(FILE_BYTES) + " bytes");
+
+    // Note that the file is little-endian, the same as the only machines we run on.
+    auto ret { std::make_shared<network>() };
+    ifs.read(reinterpret_cast<char*>(ret->feature_weights.data()), sizeof(ret->feature_weights));
+    ifs.read(reinterpret_cast<char*>(ret->feature_bias.data()),    sizeof(ret->feature_bias));
+    ifs.read(reinterpret_cast<char*>(ret->output_weights.data()),  sizeof(ret->output_weights));
+    ifs.read(reinterpret_cast<char*>(&ret->output_bias),           sizeof(ret->output_bias));
+    if (!ifs)
+        throw std::runtime_error("Unable to read network file " + path);
+
+    return ret;
+}
+
+}
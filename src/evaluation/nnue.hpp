@@ -0,0 +1,369 @@
+#pragma once
+
+// ####################################
+// DECLARATION
+// ####################################
+
+#include "pieces/pieces.hpp"
+#include "position/bitboard.hpp"
+#include "position/move.hpp"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace evaluation::nnue
+{
+
+/*********************************************************************
+* An efficiently updatable neural network (NNUE) evaluation. The     *
+* network is a simple (768 -> 256)x2 -> 1 perceptron - the inputs    *
+* are one-hot piece-squares from the perspective of each side, and   *
+* the two hidden layers (the "accumulators") go through a clipped    *
+* ReLU before being combined into the output, side-to-move first.    *
+* The accumulators are only ever updated incrementally as moves are  *
+* made and unmade, so an evaluation is just the output layer.        *
+*********************************************************************/
+
+constexpr std::size_t INPUTS { 768 };
+constexpr std::size_t HIDDEN { 256 };
+
+// The feature weights and biases are quantised by QA (which is also where the clipped ReLU clips), and the output weights
+// by QB. The network output is then scaled up into centipawns.
+constexpr int QA    { 255 };
+constexpr int QB    { 64 };
+constexpr int SCALE { 400 };
+
+// The network weights, which is also the layout of the network file (all little-endian) - int16 feature weights (indexed
+// by input, then hidden neuron), int16 feature biases, int16 output weights (side-to-move then opponent), and finally an
+// int32 output bias (quantised by QA*QB).
+struct network
+{
+    alignas(64) std::array<std::array<std::int16_t, HIDDEN>, INPUTS> feature_weights;
+    alignas(64) std::array<std::int16_t, HIDDEN> feature_bias;
+    alignas(64) std::array<std::int16_t, 2*HIDDEN> output_weights;
+    std::int32_t output_bias;
+
+    // The exact size of a network file.
+    static constexpr std::size_t FILE_BYTES { sizeof(feature_weights) + sizeof(feature_bias) + sizeof(output_weights) + sizeof(output_bias) };
+
+    // Loads the network from a file, throwing a std::runtime_error if it can't be read or is the wrong size.
+    static std::shared_ptr<network> load(const std::string& path);
+};
+
+// The hidden layer from the perspective of each side (indexed by whether the perspective is black's).
+struct accumulator
+{
+    alignas(64) std::array<std::array<std::int16_t, HIDDEN>, 2> values;
+
+    bool operator==(const accumulator& other) const noexcept = default;
+};
+
+// The input index of a piece on a square from either side's perspective. From black's perspective the board is flipped
+// and the colours are swapped, so that "our" pieces always come first.
+constexpr std::size_t get_feature_idx(piece_idx piece, std::size_t mb, bool is_black_perspective) noexcept;
+
+// Recalculates the accumulators from scratch.
+void refresh(accumulator& acc, const network& net, const bitboard& bb) noexcept;
+
+// Incrementally updates the accumulators for a (non-null) move, given the side that made the move. Note that the unmake
+// information is needed to know what (if anything) was captured.
+void make_move(accumulator& acc, const network& net, std::uint32_t make, std::uint32_t unmake, bool is_black_move) noexcept;
+void unmake_move(accumulator& acc, const network& net, std::uint32_t make, std::uint32_t unmake, bool is_black_move) noexcept;
+
+// The evaluation in centipawns, from the perspective of the side to play.
+int evaluate(const accumulator& acc, const network& net, bool is_black_to_play) noexcept;
+
+namespace details
+{
+
+// The features a move adds and removes (at most two each, for captures, promotions and castling).
+struct feature_delta
+{
+    std::array<std::size_t, 2> adds;
+    std::array<std::size_t, 2> subs;
+    std::size_t adds_size {};
+    std::size_t subs_size {};
+};
+
+feature_delta get_feature_delta(std::uint32_t make, std::uint32_t unmake, bool is_black_move, bool is_black_perspective) noexcept;
+
+// The hot loops, with the scalar versions being the reference implementation the SIMD versions are tested against. Each
+// set of kernels updates one accumulator with the feature-weight rows to add and subtract, and calculates the output layer
+// for one side-to-move accumulator and one opponent accumulator.
+struct kernels_scalar
+{
+    static void update(std::span<std::int16_t, HIDDEN> acc, std::span<const std::int16_t* const> adds, std::span<const std::int16_t* const> subs) noexcept;
+    static std::int32_t output(std::span<const std::int16_t, HIDDEN> us, std::span<const std::int16_t, HIDDEN> them, std::span<const std::int16_t, 2*HIDDEN> weights) noexcept;
+};
+
+#ifdef __AVX2__
+struct kernels_avx2
+{
+    static void update(std::span<std::int16_t, HIDDEN> acc, std::span<const std::int16_t* const> adds, std::span<const std::int16_t* const> subs) noexcept;
+    static std::int32_t output(std::span<const std::int16_t, HIDDEN> us, std::span<const std::int16_t, HIDDEN> them, std::span<const std::int16_t, 2*HIDDEN> weights) noexcept;
+};
+#endif
+
+#ifdef __AVX512BW__
+struct kernels_avx512
+{
+    static void update(std::span<std::int16_t, HIDDEN> acc, std::span<const std::int16_t* const> adds, std::span<const std::int16_t* const> subs) noexcept;
+    static std::int32_t output(std::span<const std::int16_t, HIDDEN> us, std::span<const std::int16_t, HIDDEN> them, std::span<const std::int16_t, 2*HIDDEN> weights) noexcept;
+};
+#endif
+
+// The widest kernels we were compiled for.
+#if defined(__AVX512BW__)
+using kernels = kernels_avx512;
+#elif defined(__AVX2__)
+using kernels = kernels_avx2;
+#else
+using kernels = kernels_scalar;
+#endif
+
+}
+
+}
+
+// ####################################
+// IMPLEMENTATION
+// ####################################
+
+namespace evaluation::nnue
+{
+
+constexpr std::size_t get_feature_idx(piece_idx piece, std::size_t mb, bool is_black_perspective) noexcept
+{
+    const std::size_t type     { static_cast<std::size_t>(piece & 0x07) };
+    const bool is_black_piece  { static_cast<bool>(piece & 0x08) };
+    const bool is_theirs       { is_black_piece != is_black_perspective };
+
+    return (is_theirs ? 384 : 0) + type*64 + (is_black_perspective ? (mb ^ 56) : mb);
+}
+
+namespace details
+{
+
+inline feature_delta get_feature_delta(std::uint32_t make, std::uint32_t unmake, bool is_black_move, bool is_black_perspective) noexcept
+{
+    feature_delta ret;
+    const auto add = [&ret, is_black_perspective] (piece_idx piece, std::size_t mb) { ret.adds[ret.adds_size++] = get_feature_idx(piece, mb, is_black_perspective); };
+    const auto sub = [&ret, is_black_perspective] (piece_idx piece, std::size_t mb) { ret.subs[ret.subs_size++] = get_feature_idx(piece, mb, is_black_perspective); };
+
+    const std::size_t from_mb { move::make_decode_from_mb(make) };
+    const std::size_t to_mb   { move::make_decode_to_mb(make) };
+    const piece_idx piece     { move::make_decode_piece_idx(make) };
+
+    // The moving piece (which might turn into something else on the way).
+    sub(piece, from_mb);
+    add((make & move::type::PROMOTION) ? move::make_decode_promotion(make) : piece, to_mb);
+
+    // Anything captured.
+    if (make & move::type::EN_PASSENT) [[unlikely]]
+        sub(is_black_move ? piece_idx::w_pawn : piece_idx::b_pawn, is_black_move ? to_mb+8 : to_mb-8);
+    else if (make & move::type::CAPTURE)
+        sub(move::unmake_decode_capture(unmake), to_mb);
+
+    // The rook hopping over the king when castling.
+    if (make & move::type::CASTLE_KS) [[unlikely]]
+    {
+        const piece_idx rook { is_black_move ? piece_idx::b_rook : piece_idx::w_rook };
+        sub(rook, from_mb+3);
+        add(rook, from_mb+1);
+    }
+    else if (make & move::type::CASTLE_QS) [[unlikely]]
+    {
+        const piece_idx rook { is_black_move ? piece_idx::b_rook : piece_idx::w_rook };
+        sub(rook, from_mb-4);
+        add(rook, from_mb-1);
+    }
+
+    return ret;
+}
+
+inline void kernels_scalar::update(std::span<std::int16_t, HIDDEN> acc, std::span<const std::int16_t* const> adds, std::span<const std::int16_t* const> subs) noexcept
+{
+    for (std::size_t i = 0; i < HIDDEN; i++)
+    {
+        std::int16_t v { acc[i] };
+        for (const std::int16_t* w : adds)
+            v = static_cast<std::int16_t>(v + w[i]);
+        for (const std::int16_t* w : subs)
+            v = static_cast<std::int16_t>(v - w[i]);
+        acc[i] = v;
+    }
+}
+
+inline std::int32_t kernels_scalar::output(std::span<const std::int16_t, HIDDEN> us, std::span<const std::int16_t, HIDDEN> them, std::span<const std::int16_t, 2*HIDDEN> weights) noexcept
+{
+    std::int32_t ret {};
+
+    for (std::size_t i = 0; i < HIDDEN; i++)
+    {
+        ret += std::clamp<std::int32_t>(us[i],   0, QA) * weights[i];
+        ret += std::clamp<std::int32_t>(them[i], 0, QA) * weights[HIDDEN+i];
+    }
+
+    return ret;
+}
+
+#ifdef __AVX2__
+inline void kernels_avx2::update(std::span<std::int16_t, HIDDEN> acc, std::span<const std::int16_t* const> adds, std::span<const std::int16_t* const> subs) noexcept
+{
+    constexpr std::size_t LANES { sizeof(__m256i)/sizeof(std::int16_t) };
+    static_assert(HIDDEN % LANES == 0);
+
+    for (std::size_t i = 0; i < HIDDEN; i += LANES)
+    {
+        __m256i v { _mm256_load_si256(reinterpret_cast<const __m256i*>(acc.data()+i)) };
+        for (const std::int16_t* w : adds)
+            v = _mm256_add_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(w+i)));
+        for (const std::int16_t* w : subs)
+            v = _mm256_sub_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(w+i)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc.data()+i), v);
+    }
+}
+
+inline std::int32_t kernels_avx2::output(std::span<const std::int16_t, HIDDEN> us, std::span<const std::int16_t, HIDDEN> them, std::span<const std::int16_t, 2*HIDDEN> weights) noexcept
+{
+    constexpr std::size_t LANES { sizeof(__m256i)/sizeof(std::int16_t) };
+    static_assert(HIDDEN % LANES == 0);
+
+    const __m256i zero { _mm256_setzero_si256() };
+    const __m256i qa   { _mm256_set1_epi16(QA) };
+
+    // The clipped values are at most QA, so each pair of products that madd sums up comfortably fits in 32 bits.
+    __m256i sum { _mm256_setzero_si256() };
+    for (std::size_t i = 0; i < HIDDEN; i += LANES)
+    {
+        const __m256i u { _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(us.data()+i)),   zero), qa) };
+        const __m256i t { _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(them.data()+i)), zero), qa) };
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(u, _mm256_load_si256(reinterpret_cast<const __m256i*>(weights.data()+i))));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(t, _mm256_load_si256(reinterpret_cast<const __m256i*>(weights.data()+HIDDEN+i))));
+    }
+
+    // Horizontal sum of the eight 32-bit lanes.
+    __m128i sum128 { _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)) };
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum128);
+}
+#endif
+
+#ifdef __AVX512BW__
+inline void kernels_avx512::update(std::span<std::int16_t, HIDDEN> acc, std::span<const std::int16_t* const> adds, std::span<const std::int16_t* const> subs) noexcept
+{
+    constexpr std::size_t LANES { sizeof(__m512i)/sizeof(std::int16_t) };
+    static_assert(HIDDEN % LANES == 0);
+
+    for (std::size_t i = 0; i < HIDDEN; i += LANES)
+    {
+        __m512i v { _mm512_load_si512(acc.data()+i) };
+        for (const std::int16_t* w : adds)
+            v = _mm512_add_epi16(v, _mm512_load_si512(w+i));
+        for (const std::int16_t* w : subs)
+            v = _mm512_sub_epi16(v, _mm512_load_si512(w+i));
+        _mm512_store_si512(acc.data()+i, v);
+    }
+}
+
+inline std::int32_t kernels_avx512::output(std::span<const std::int16_t, HIDDEN> us, std::span<const std::int16_t, HIDDEN> them, std::span<const std::int16_t, 2*HIDDEN> weights) noexcept
+{
+    constexpr std::size_t LANES { sizeof(__m512i)/sizeof(std::int16_t) };
+    static_assert(HIDDEN % LANES == 0);
+
+    const __m512i zero { _mm512_setzero_si512() };
+    const __m512i qa   { _mm512_set1_epi16(QA) };
+
+    __m512i sum { _mm512_setzero_si512() };
+    for (std::size_t i = 0; i < HIDDEN; i += LANES)
+    {
+        const __m512i u { _mm512_min_epi16(_mm512_max_epi16(_mm512_load_si512(us.data()+i),   zero), qa) };
+        const __m512i t { _mm512_min_epi16(_mm512_max_epi16(_mm512_load_si512(them.data()+i), zero), qa) };
+        sum = _mm512_add_epi32(sum, _mm512_madd_epi16(u, _mm512_load_si512(weights.data()+i)));
+        sum = _mm512_add_epi32(sum, _mm512_madd_epi16(t, _mm512_load_si512(weights.data()+HIDDEN+i)));
+    }
+
+    // Horizontal sum of the sixteen 32-bit lanes. We go through memory to split the halves, as the extract intrinsics trip
+    // up GCC's uninitialised-variable warnings.
+    alignas(64) std::array<std::int32_t, 16> lanes;
+    _mm512_store_si512(lanes.data(), sum);
+    const __m256i sum256 { _mm256_add_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.data())), _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.data()+8))) };
+    __m128i sum128 { _mm_add_epi32(_mm256_castsi256_si128(sum256), _mm256_extracti128_si256(sum256, 1)) };
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum128);
+}
+#endif
+
+// Applies the move's feature changes to both accumulators, the other way around when unmaking.
+inline void apply_move(accumulator& acc, const network& net, std::uint32_t make, std::uint32_t unmake, bool is_black_move, bool is_unmake) noexcept
+{
+    for (const bool is_black_perspective : { false, true })
+    {
+        const feature_delta delta { get_feature_delta(make, unmake, is_black_move, is_black_perspective) };
+
+        std::array<const std::int16_t*, 2> adds;
+        std::array<const std::int16_t*, 2> subs;
+        for (std::size_t i = 0; i < delta.adds_size; i++)
+            adds[i] = net.feature_weights[delta.adds[i]].data();
+        for (std::size_t i = 0; i < delta.subs_size; i++)
+            subs[i] = net.feature_weights[delta.subs[i]].data();
+
+        const std::span<const std::int16_t* const> add_rows { adds.data(), delta.adds_size };
+        const std::span<const std::int16_t* const> sub_rows { subs.data(), delta.subs_size };
+        if (is_unmake)
+            kernels::update(acc.values[is_black_perspective], sub_rows, add_rows);
+        else
+            kernels::update(acc.values[is_black_perspective], add_rows, sub_rows);
+    }
+}
+
+}
+
+inline void refresh(accumulator& acc, const network& net, const bitboard& bb) noexcept
+{
+    for (const bool is_black_perspective : { false, true })
+    {
+        auto& values { acc.values[is_black_perspective] };
+        values = net.feature_bias;
+
+        for (std::size_t piece = piece_idx::w_pawn; piece <= piece_idx::b_queen; piece++)
+        {
+            if (piece == piece_idx::w_any || piece == piece_idx::b_any)
+                continue;
+
+            for (std::uint64_t piece_bb { bb.boards[piece] }; piece_bb; piece_bb &= piece_bb-1)
+            {
+                const std::size_t mb { static_cast<std::size_t>(std::countr_zero(piece_bb)) };
+                const std::array<const std::int16_t*, 1> add { net.feature_weights[get_feature_idx(static_cast<piece_idx>(piece), mb, is_black_perspective)].data() };
+                details::kernels::update(values, add, {});
+            }
+        }
+    }
+}
+
+inline void make_move(accumulator& acc, const network& net, std::uint32_t make, std::uint32_t unmake, bool is_black_move) noexcept
+{
+    details::apply_move(acc, net, make, unmake, is_black_move, false);
+}
+
+inline void unmake_move(accumulator& acc, const network& net, std::uint32_t make, std::uint32_t unmake, bool is_black_move) noexcept
+{
+    details::apply_move(acc, net, make, unmake, is_black_move, true);
+}
+
+inline int evaluate(const accumulator& acc, const network& net, bool is_black_to_play) noexcept
+{
+    const std::int32_t output { details::kernels::output(acc.values[is_black_to_play], acc.values[!is_black_to_play], net.output_weights) };
+    return static_cast<int>((static_cast<std::int64_t>(output) + net.output_bias) * SCALE / (QA*QB));
+}
+
+}
@@ -0,0 +1,476 @@
+#include "tuning.hpp"
+
+#include "config.hpp"
+#include "evaluation/evaluate_king_safety.hpp"
+#include "evaluation/evaluate_material.hpp"
+#include "evaluation/evaluate_pawn_structure.hpp"
+#include "evaluation/evaluate_piece_square.hpp"
+#include "evaluation/game_phase.hpp"
+#include "pieces/pieces.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace evaluation::tuning
+{
+
+namespace
+{
+
+// The order (and names) the piece types are written out in.
+constexpr std::array<std::size_t, 6> piece_type_order { piece_idx::w_pawn, piece_idx::w_knight, piece_idx::w_bishop, piece_idx::w_rook, piece_idx::w_queen, piece_idx::w_king };
+constexpr std::array<const char*, 6> piece_type_names { "pawn", "king", "knight", "bishop", "rook", "queen" };
+
+// The raw piece-square tables indexed by piece type.
+constexpr std::array<const pst*, 6> mg_psts { &details::pawn_mg_pst, &details::king_mg_pst, &details::knight_mg_pst, &details::bishop_mg_pst, &details::rook_mg_pst, &details::queen_mg_pst };
+constexpr std::array<const pst*, 6> eg_psts { &details::pawn_eg_pst, &details::king_eg_pst, &details::knight_eg_pst, &details::bishop_eg_pst, &details::rook_eg_pst, &details::queen_eg_pst };
+
+// Runs the function over contiguous chunks of [0, size) across the given number of threads. The function is given the chunk
+// index as well as the chunk itself.
+template<typename Func>
+void parallel_for_chunks(std::size_t size, std::size_t threads, Func func)
+{
+    threads = std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(size, 1));
+    if (threads == 1)
+    {
+        func(0, 0, size);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; i++)
+        workers.emplace_back(func, i, size*i/threads, size*(i+1)/threads);
+    for (auto& worker : workers)
+        worker.join();
+}
+
+double sigmoid(double k, double eval) noexcept
+{
+    return 1.0 / (1.0 + std::pow(10.0, -k*eval/400.0));
+}
+
+void write_values(std::ostream& os, const char* type, const std::string& name, std::span<const int> values, std::size_t per_line)
+{
+    os << "constexpr std::array<" << type << ", " << values.size() << "> " << name << " {";
+    if (per_line >= values.size())
+    {
+        for (std::size_t i = 0; i < values.size(); i++)
+            os << (i ? ", " : " ") << values[i];
+        os << " };\n";
+        return;
+    }
+
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        os << ((i % per_line) ? ", " : "\n    ") << std::setw(4) << values[i];
+        if (i+1 < values.size() && (i+1) % per_line == 0)
+            os << ',';
+    }
+    os << "\n};\n";
+}
+
+}
+
+weights get_default_weights() noexcept
+{
+    weights ret {};
+
+    for (std::size_t type = 0; type < 6; type++)
+    {
+        ret[MATERIAL_OFFSET + type] = { static_cast<double>(piece_mg_evaluation[type]), static_cast<double>(piece_eg_evaluation[type]) };
+        for (std::size_t i = 0; i < 64; i++)
+            ret[PIECE_SQUARE_OFFSET + type*64 + i] = { static_cast<double>((*mg_psts[type])[i]), static_cast<double>((*eg_psts[type])[i]) };
+    }
+
+    ret[ISOLATED_PAWNS] = { details::isolated_pawns_penalty_mg, details::isolated_pawns_penalty_eg };
+    ret[DOUBLED_PAWNS]  = { details::doubled_pawns_penalty_mg,  details::doubled_pawns_penalty_eg  };
+    ret[BLOCKED_PAWNS]  = { details::blocked_pawns_penalty_mg,  details::blocked_pawns_penalty_eg  };
+
+    for (std::size_t i = 0; i < 7; i++)
+        ret[PAWN_SHIELD_NUMBER_OFFSET + i] = { static_cast<double>(details::pawn_shield_number_evaluation_mg[i]), static_cast<double>(details::pawn_shield_number_evaluation_eg[i]) };
+    ret[PAWN_SHIELD_HOLE] = { details::pawn_shield_hole_mg,      details::pawn_shield_hole_eg      };
+    ret[KING_MOBILITY]    = { details::king_mobility_penalty_mg, details::king_mobility_penalty_eg };
+
+    return ret;
+}
+
+void write_header(std::ostream& os, const weights& w)
+{
+    const auto mg = [&w] (std::size_t idx) { return static_cast<int>(std::lround(w[idx].mg)); };
+    const auto eg = [&w] (std::size_t idx) { return static_cast<int>(std::lround(w[idx].eg)); };
+
+    os << "#pragma once\n"
+       << "\n"
+       << "// The parameters of the hand-crafted evaluation (in centipawns). This file is generated by waychess-tune, which tunes\n"
+       << "// these against a dataset of labelled positions starting from the values compiled in, so shouldn't be edited by hand.\n"
+       << "\n"
+       << "#include <array>\n"
+       << "\n"
+       << "namespace evaluation\n"
+       << "{\n"
+       << "\n"
+       << "namespace details\n"
+       << "{\n"
+       << "\n"
+       << "// Piece values.\n";
+    for (const std::size_t type : piece_type_order)
+    {
+        const std::string name { std::string("white_") + piece_type_names[type] };
+        os << "constexpr int " << std::left << std::setw(26) << (name + "_mg_evaluation") << std::right << " { " << mg(MATERIAL_OFFSET + type) << " };\n";
+        os << "constexpr int " << std::left << std::setw(26) << (name + "_eg_evaluation") << std::right << " { " << eg(MATERIAL_OFFSET + type) << " };\n";
+    }
+
+    os << "\n// Piece-square tables, from black's perspective.\n";
+    for (const std::size_t type : piece_type_order)
+    {
+        std::array<int, 64> mg_values, eg_values;
+        for (std::size_t i = 0; i < 64; i++)
+        {
+            mg_values[i] = mg(PIECE_SQUARE_OFFSET + type*64 + i);
+            eg_values[i] = eg(PIECE_SQUARE_OFFSET + type*64 + i);
+        }
+        write_values(os, "int", std::string(piece_type_names[type]) + "_mg_pst", mg_values, 8);
+        os << '\n';
+        write_values(os, "int", std::string(piece_type_names[type]) + "_eg_pst", eg_values, 8);
+        os << '\n';
+    }
+
+    os << "// Pawn-structure penalties.\n"
+       << "constexpr int isolated_pawns_penalty_mg { " << mg(ISOLATED_PAWNS) << " };\n"
+       << "constexpr int isolated_pawns_penalty_eg { " << eg(ISOLATED_PAWNS) << " };\n"
+       << "constexpr int doubled_pawns_penalty_mg  { " << mg(DOUBLED_PAWNS)  << " };\n"
+       << "constexpr int doubled_pawns_penalty_eg  { " << eg(DOUBLED_PAWNS)  << " };\n"
+       << "constexpr int blocked_pawns_penalty_mg  { " << mg(BLOCKED_PAWNS)  << " };\n"
+       << "constexpr int blocked_pawns_penalty_eg  { " << eg(BLOCKED_PAWNS)  << " };\n"
+       << "\n"
+       << "// King safety.\n";
+    std::array<int, 7> shield_mg, shield_eg;
+    for (std::size_t i = 0; i < 7; i++)
+    {
+        shield_mg[i] = mg(PAWN_SHIELD_NUMBER_OFFSET + i);
+        shield_eg[i] = eg(PAWN_SHIELD_NUMBER_OFFSET + i);
+    }
+    write_values(os, "int", "pawn_shield_number_evaluation_mg", shield_mg, 8);
+    write_values(os, "int", "pawn_shield_number_evaluation_eg", shield_eg, 8);
+    os << "constexpr int pawn_shield_hole_mg      { " << mg(PAWN_SHIELD_HOLE) << " };\n"
+       << "constexpr int pawn_shield_hole_eg      { " << eg(PAWN_SHIELD_HOLE) << " };\n"
+       << "constexpr int king_mobility_penalty_mg { " << mg(KING_MOBILITY)    << " };\n"
+       << "constexpr int king_mobility_penalty_eg { " << eg(KING_MOBILITY)    << " };\n"
+       << "\n"
+       << "}\n"
+       << "\n"
+       << "}\n";
+}
+
+std::size_t get_features(const bitboard& bb, std::vector<feature>& features)
+{
+    // Collect up all the coefficients before merging - the same parameter can come up for both sides (e.g. a white and
+    // black piece on mirrored squares), in which case they may cancel out.
+    std::vector<std::pair<std::size_t, int>> coefs;
+    coefs.reserve(48);
+
+    for (std::size_t type = 0; type < 6; type++)
+    {
+        const std::uint64_t white_bb { bb.boards[type] };
+        const std::uint64_t black_bb { bb.boards[type | 0x08] };
+
+        coefs.emplace_back(MATERIAL_OFFSET + type, std::popcount(white_bb) - std::popcount(black_bb));
+
+        // White's tables are the flipped tables, and black's are the tables themselves.
+        for (std::uint64_t piece_bb { white_bb }; piece_bb; piece_bb &= piece_bb-1)
+            coefs.emplace_back(PIECE_SQUARE_OFFSET + type*64 + (std::countr_zero(piece_bb) ^ 56), 1);
+        for (std::uint64_t piece_bb { black_bb }; piece_bb; piece_bb &= piece_bb-1)
+            coefs.emplace_back(PIECE_SQUARE_OFFSET + type*64 + std::countr_zero(piece_bb), -1);
+    }
+
+    // Pawn-structure terms are penalties, so they count the other way around.
+    if constexpr (config::eval_ps)
+    {
+        const std::uint64_t w_pawns { bb.boards[piece_idx::w_pawn] };
+        const std::uint64_t b_pawns { bb.boards[piece_idx::b_pawn] };
+        const std::uint64_t occ     { bb.boards[piece_idx::w_any] | bb.boards[piece_idx::b_any] };
+
+        coefs.emplace_back(ISOLATED_PAWNS, std::popcount(get_pawn_isolated(b_pawns)) - std::popcount(get_pawn_isolated(w_pawns)));
+        coefs.emplace_back(DOUBLED_PAWNS,  std::popcount(get_pawn_doubled(b_pawns))  - std::popcount(get_pawn_doubled(w_pawns)));
+        coefs.emplace_back(BLOCKED_PAWNS,  std::popcount(get_black_pawn_blocked(b_pawns, occ)) - std::popcount(get_white_pawn_blocked(w_pawns, occ)));
+    }
+
+    if constexpr (config::eval_ks)
+    {
+        const details::king_safety_terms white { details::get_king_safety_terms(bb, false) };
+        const details::king_safety_terms black { details::get_king_safety_terms(bb, true)  };
+
+        coefs.emplace_back(PAWN_SHIELD_NUMBER_OFFSET + white.shield_number, 1);
+        coefs.emplace_back(PAWN_SHIELD_NUMBER_OFFSET + black.shield_number, -1);
+        coefs.emplace_back(PAWN_SHIELD_HOLE, static_cast<int>(white.is_pawn_on_king_file) - static_cast<int>(black.is_pawn_on_king_file));
+        coefs.emplace_back(KING_MOBILITY, white.mobility - black.mobility);
+    }
+
+    std::sort(coefs.begin(), coefs.end());
+
+    std::size_t ret {};
+    for (auto it = coefs.begin(); it != coefs.end(); )
+    {
+        const std::size_t idx { it->first };
+        int coef {};
+        for (; it != coefs.end() && it->first == idx; it++)
+            coef += it->second;
+
+        if (coef)
+        {
+            features.push_back(encode_feature(idx, coef));
+            ret++;
+        }
+    }
+
+    return ret;
+}
+
+double evaluate(const weights& w, std::span<const feature> features, int gp) noexcept
+{
+    double mg {}, eg {};
+    for (const feature f : features)
+    {
+        const weight& v { w[decode_feature_idx(f)] };
+        const int coef  { decode_feature_coef(f) };
+        mg += coef*v.mg;
+        eg += coef*v.eg;
+    }
+
+    return (mg*gp + eg*(24-gp))/24;
+}
+
+void dataset::add(const bitboard& bb, double result)
+{
+    tuning::get_features(bb, features);
+    offsets.push_back(features.size());
+    phases.push_back(static_cast<std::uint8_t>(std::min(evaluate_gp(bb), 24)));
+    results.push_back(static_cast<std::uint8_t>(std::lround(2*result)));
+}
+
+void dataset::append(const dataset& other)
+{
+    const std::size_t base { features.size() };
+    features.insert(features.end(), other.features.begin(), other.features.end());
+    for (std::size_t i = 1; i < other.offsets.size(); i++)
+        offsets.push_back(base + other.offsets[i]);
+    phases.insert(phases.end(), other.phases.begin(), other.phases.end());
+    results.insert(results.end(), other.results.begin(), other.results.end());
+}
+
+void parse_labelled_position(std::string_view line, bitboard& bb, double& result)
+{
+    // The result - the game result strings can't appear in a FEN so we look for those first.
+    if (line.find("1/2-1/2") != std::string_view::npos)
+        result = 0.5;
+    else if (line.find("1-0") != std::string_view::npos)
+        result = 1.0;
+    else if (line.find("0-1") != std::string_view::npos)
+        result = 0.0;
+    else if (const auto pos = line.find('['); pos != std::string_view::npos)
+        result = std::stod(std::string(line.substr(pos+1)));
+    else if (const auto pos = line.find(','); pos != std::string_view::npos)
+        result = std::stod(std::string(line.substr(pos+1)));
+    else
+        throw std::invalid_argument("No result in labelled position");
+
+    if (!(result >= 0.0 && result <= 1.0))
+        throw std::invalid_argument("Result of labelled position out of range");
+
+    // The first four fields of the FEN, stopping at the comma of a CSV.
+    std::istringstream ss(std::string(line.substr(0, line.find(','))));
+    std::array<std::string, 4> fields;
+    for (auto& field : fields)
+        if (!(ss >> field))
+            throw std::invalid_argument("Incomplete FEN in labelled position");
+
+    bb = bitboard(fields[0] + ' ' + fields[1] + ' ' + fields[2] + ' ' + fields[3] + " 0 1");
+
+    // The evaluation assumes we have exactly one king each.
+    if (std::popcount(bb.boards[piece_idx::w_king]) != 1 || std::popcount(bb.boards[piece_idx::b_king]) != 1)
+        throw std::invalid_argument("Labelled position must have one king each");
+}
+
+dataset load_dataset(const std::string& path, std::size_t threads, std::size_t& skipped)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs)
+        throw std::runtime_error("Unable to open dataset " + path);
+
+    const std::string contents { std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+
+    // Each thread parses a chunk of the file, starting and ending on line boundaries.
+    std::vector<dataset> parts(std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(contents.size(), 1)));
+    std::vector<std::size_t> part_skipped(parts.size());
+    parallel_for_chunks(contents.size(), parts.size(), [&] (std::size_t part, std::size_t begin, std::size_t end)
+    {
+        const auto to_line_start = [&contents] (std::size_t pos)
+        {
+            if (pos == 0 || pos >= contents.size())
+                return std::min(pos, contents.size());
+            const auto newline { contents.find('\n', pos-1) };
+            return newline == std::string::npos ? contents.size() : newline+1;
+        };
+
+        const std::string_view view { contents };
+        for (std::size_t pos = to_line_start(begin), last = to_line_start(end); pos < last; )
+        {
+            auto newline { view.find('\n', pos) };
+            if (newline == std::string_view::npos)
+                newline = view.size();
+
+            std::string_view line { view.substr(pos, newline-pos) };
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            pos = newline+1;
+
+            if (line.find_first_not_of(" \t") == std::string_view::npos)
+                continue;
+
+            try
+            {
+                bitboard bb;
+                double result;
+                parse_labelled_position(line, bb, result);
+                parts[part].add(bb, result);
+            }
+            catch (const std::exception&)
+            {
+                part_skipped[part]++;
+            }
+        }
+    });
+
+    dataset ret { std::move(parts[0]) };
+    for (std::size_t i = 1; i < parts.size(); i++)
+        ret.append(parts[i]);
+
+    skipped = 0;
+    for (const std::size_t v : part_skipped)
+        skipped += v;
+
+    return ret;
+}
+
+double get_error(const dataset& data, const weights& w, double k, std::size_t threads, weights* gradient)
+{
+    if (data.size() == 0)
+        return 0.0;
+
+    threads = std::clamp<std::size_t>(threads, 1, data.size());
+
+    // Each thread sums up its own error and gradient, which we then add up in order (so the result doesn't depend on the
+    // scheduling of the threads).
+    std::vector<double> errors(threads);
+    std::vector<weights> gradients(gradient ? threads : 0);
+    parallel_for_chunks(data.size(), threads, [&] (std::size_t thread, std::size_t begin, std::size_t end)
+    {
+        double error {};
+        weights* const g { gradient ? &gradients[thread] : nullptr };
+        if (g)
+            g->fill({});
+
+        for (std::size_t i = begin; i < end; i++)
+        {
+            const auto features { data.get_features(i) };
+            const int gp        { data.phases[i] };
+            const double s      { sigmoid(k, evaluate(w, features, gp)) };
+            const double diff   { s - data.get_result(i) };
+            error += diff*diff;
+
+            if (g)
+            {
+                // The derivative of the squared error with respect to the evaluation, which is then split between the
+                // middle-game and end-game weights according to the game phase.
+                const double d  { 2*diff*s*(1-s)*k*std::log(10.0)/400.0 };
+                const double mg { d*gp/24 };
+                const double eg { d*(24-gp)/24 };
+                for (const feature f : features)
+                {
+                    weight& v { (*g)[decode_feature_idx(f)] };
+                    const int coef { decode_feature_coef(f) };
+                    v.mg += coef*mg;
+                    v.eg += coef*eg;
+                }
+            }
+        }
+
+        errors[thread] = error;
+    });
+
+    const double n { static_cast<double>(data.size()) };
+    if (gradient)
+    {
+        gradient->fill({});
+        for (const auto& g : gradients)
+            for (std::size_t i = 0; i < PARAMETERS; i++)
+            {
+                (*gradient)[i].mg += g[i].mg/n;
+                (*gradient)[i].eg += g[i].eg/n;
+            }
+    }
+
+    double ret {};
+    for (const double error : errors)
+        ret += error;
+    return ret/n;
+}
+
+double find_k(const dataset& data, const weights& w, std::size_t threads)
+{
+    // A golden-section search, assuming the error is unimodal in k (which it is for any sensible evaluation).
+    const double ratio { (std::sqrt(5.0) - 1)/2 };
+    double lo { 0.0 }, hi { 4.0 };
+    double a { hi - ratio*(hi-lo) }, b { lo + ratio*(hi-lo) };
+    double error_a { get_error(data, w, a, threads) }, error_b { get_error(data, w, b, threads) };
+
+    while (hi - lo > 1e-4)
+    {
+        if (error_a < error_b)
+        {
+            hi = b;
+            b = a; error_b = error_a;
+            a = hi - ratio*(hi-lo); error_a = get_error(data, w, a, threads);
+        }
+        else
+        {
+            lo = a;
+            a = b; error_a = error_b;
+            b = lo + ratio*(hi-lo); error_b = get_error(data, w, b, threads);
+        }
+    }
+
+    return (lo + hi)/2;
+}
+
+void optimiser::step(weights& w, const weights& gradient) noexcept
+{
+    constexpr double EPSILON { 1e-8 };
+
+    _t++;
+    const double correction1 { 1 - std::pow(beta1, static_cast<double>(_t)) };
+    const double correction2 { 1 - std::pow(beta2, static_cast<double>(_t)) };
+
+    const auto update = [&] (double& value, double& m, double& v, double g)
+    {
+        m = beta1*m + (1-beta1)*g;
+        v = beta2*v + (1-beta2)*g*g;
+        value -= learning_rate * (m/correction1) / (std::sqrt(v/correction2) + EPSILON);
+    };
+
+    for (std::size_t i = 0; i < PARAMETERS; i++)
+    {
+        update(w[i].mg, _m[i].mg, _v[i].mg, gradient[i].mg);
+        update(w[i].eg, _m[i].eg, _v[i].eg, gradient[i].eg);
+    }
+}
+
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "position/bitboard.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace evaluation::tuning
+{
+
+/*********************************************************************
+* Texel-style tuning of the hand-crafted evaluation. Every term of   *
+* the evaluation is linear in its parameters (for a given game       *
+* phase), so each labelled position is boiled down to a sparse list  *
+* of features - a parameter index and a coefficient (white's count   *
+* minus black's). Evaluating a position is then just a dot product   *
+* with the weights, and the gradient of the error is cheap enough to *
+* calculate over millions of positions in every iteration.           *
+*********************************************************************/
+
+// The layout of the parameters, each having a middle-game and end-game weight. Material and piece-square parameters are
+// indexed by piece type, and piece-square parameters are in the (black's perspective) order of the tables themselves.
+constexpr std::size_t MATERIAL_OFFSET           { 0 };
+constexpr std::size_t PIECE_SQUARE_OFFSET       { MATERIAL_OFFSET + 6 };
+constexpr std::size_t ISOLATED_PAWNS            { PIECE_SQUARE_OFFSET + 6*64 };
+constexpr std::size_t DOUBLED_PAWNS             { ISOLATED_PAWNS + 1 };
+constexpr std::size_t BLOCKED_PAWNS             { DOUBLED_PAWNS + 1 };
+constexpr std::size_t PAWN_SHIELD_NUMBER_OFFSET { BLOCKED_PAWNS + 1 };
+constexpr std::size_t PAWN_SHIELD_HOLE          { PAWN_SHIELD_NUMBER_OFFSET + 7 };
+constexpr std::size_t KING_MOBILITY             { PAWN_SHIELD_HOLE + 1 };
+constexpr std::size_t PARAMETERS                { KING_MOBILITY + 1 };
+
+struct weight
+{
+    double mg, eg;
+};
+
+using weights = std::array<weight, PARAMETERS>;
+
+// The weights currently compiled into the evaluation.
+weights get_default_weights() noexcept;
+
+// Writes the weights out (rounded to centipawns) as the evaluation parameters header.
+void write_header(std::ostream& os, const weights& w);
+
+// A feature is packed into 16 bits, with the parameter index in the bottom 10 bits and the (signed) coefficient above.
+using feature = std::uint16_t;
+
+constexpr feature encode_feature(std::size_t idx, int coef) noexcept { return static_cast<feature>((coef << 10) | idx); }
+constexpr std::size_t decode_feature_idx(feature f) noexcept { return f & 0x3ff; }
+constexpr int decode_feature_coef(feature f) noexcept { return static_cast<std::int16_t>(f) >> 10; }
+
+// Appends the features of a position, returning the number appended.
+std::size_t get_features(const bitboard& bb, std::vector<feature>& features);
+
+// The evaluation (from white's perspective) of a position from its features.
+double evaluate(const weights& w, std::span<const feature> features, int gp) noexcept;
+
+// Labelled positions, packed as features in struct-of-arrays form.
+struct dataset
+{
+    // The features of every position back-to-back, with each position's features starting at its offset.
+    std::vector<feature> features;
+    std::vector<std::size_t> offsets { 0 };
+
+    // The game phase (capped at 24) and result (0, 1 or 2 for a black win, draw or white win) of each position.
+    std::vector<std::uint8_t> phases;
+    std::vector<std::uint8_t> results;
+
+    std::size_t size() const noexcept { return phases.size(); }
+    std::span<const feature> get_features(std::size_t i) const noexcept { return { features.data() + offsets[i], offsets[i+1] - offsets[i] }; }
+    double get_result(std::size_t i) const noexcept { return results[i] / 2.0; }
+
+    void add(const bitboard& bb, double result);
+    void append(const dataset& other);
+};
+
+// Parses a labelled position, with the result (from white's perspective) given in any of the common formats:
+//     EPD:  <fen> c9 "1/2-1/2";
+//     FEN:  <fen> [0.5]
+//     CSV:  <fen>,0.5
+// Only the first four fields of the FEN are used. Throws (a std::logic_error) if the line can't be parsed.
+void parse_labelled_position(std::string_view line, bitboard& bb, double& result);
+
+// Loads a dataset from a file of labelled positions (one per line) across the given number of threads, returning the
+// number of lines that couldn't be parsed through skipped.
+dataset load_dataset(const std::string& path, std::size_t threads, std::size_t& skipped);
+
+// The mean squared error between the results and the sigmoid of the scaled evaluations. If a gradient is given, this is
+// also filled in with the gradient of the error for every weight.
+double get_error(const dataset& data, const weights& w, double k, std::size_t threads, weights* gradient = nullptr);
+
+// Finds the scaling constant of the sigmoid that best fits the evaluation to the results.
+double find_k(const dataset& data, const weights& w, std::size_t threads);
+
+// Adam optimiser state for the weights.
+struct optimiser
+{
+    explicit optimiser(double learning_rate) noexcept : learning_rate { learning_rate } {}
+
+    double learning_rate;
+    double beta1 { 0.9 };
+    double beta2 { 0.999 };
+
+    // Takes a single step given the gradient of the error.
+    void step(weights& w, const weights& gradient) noexcept;
+
+private:
+    weights _m {};
+    weights _v {};
+    std::size_t _t {};
+};
+
+}
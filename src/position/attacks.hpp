@@ -2,6 +2,10 @@
 
 #include "bitboard.hpp"
 #include "pieces/pieces.hpp"
+#include "position/move.hpp"
+
+#include <array>
+#include <bit>
 
 inline std::uint64_t get_attackers(const bitboard& bb, std::size_t mb) noexcept
 {
@@ -89,9 +93,19 @@ inline bool is_attacked_black(const bitboard& bb, auto... mb) noexcept
     return false;
 }
 
+// Whether the king of the given side (black if Black) is in check, with the side known at compile time.
+template <bool Black>
+inline bool is_in_check(const bitboard& bb)
+{
+    if constexpr (Black)
+        return is_attacked_white(bb, std::countr_zero(bb.boards[piece_idx::b_king]));
+    else
+        return is_attacked_black(bb, std::countr_zero(bb.boards[piece_idx::w_king]));
+}
+
 inline bool is_in_check(const bitboard& bb, bool is_black_to_play)
 {
-    return is_black_to_play ? is_attacked_white(bb, std::countr_zero(bb.boards[piece_idx::b_king])) : is_attacked_black(bb, std::countr_zero(bb.boards[piece_idx::w_king]));
+    return is_black_to_play ? is_in_check<true>(bb) : is_in_check<false>(bb);
 }
 
 inline bool is_in_check(const bitboard& bb)
@@ -99,4 +113,133 @@ inline bool is_in_check(const bitboard& bb)
     return is_in_check(bb, bb.is_black_to_play());
 }
 
+// Everything we need to know to tell whether a move of the side to play gives check, without having to make the move. This
+// is worked out once per node, after which gives_check is usually just a bitboard AND per move.
+struct check_info
+{
+    // The squares each of our pieces would give check from (indexed by the colourless piece type). Kings can't give check
+    // directly.
+    std::array<std::uint64_t, 6> check_squares;
+
+    // Our pieces that are the only piece between one of our sliders and the opponent king - moving one of these off the line
+    // gives a discovered check.
+    std::uint64_t discovered_blockers;
+};
 
+template <bool Black>
+inline check_info get_check_info(const bitboard& bb) noexcept
+{
+    constexpr bool is_black_to_play { Black };
+    const std::uint64_t pieces_bb { bb.boards[piece_idx::w_any] | bb.boards[piece_idx::b_any] };
+    const std::uint64_t our_bb    { bb.boards[is_black_to_play ? piece_idx::b_any : piece_idx::w_any] };
+    const std::size_t king_mb     { static_cast<std::size_t>(std::countr_zero(bb.boards[is_black_to_play ? piece_idx::w_king : piece_idx::b_king])) };
+
+    check_info ret {};
+
+    // Our pawns attack the king from the squares one of their pawns on the king square would attack.
+    ret.check_squares[piece_idx::w_pawn]   = is_black_to_play ? get_white_pawn_all_attacked_squares_from_mailbox(king_mb) : get_black_pawn_all_attacked_squares_from_mailbox(king_mb);
+    ret.check_squares[piece_idx::w_knight] = get_knight_attacked_squares_from_mailbox(king_mb);
+    ret.check_squares[piece_idx::w_bishop] = get_bishop_attacked_squares_from_mailbox(pieces_bb, king_mb);
+    ret.check_squares[piece_idx::w_rook]   = get_rook_attacked_squares_from_mailbox(pieces_bb, king_mb);
+    ret.check_squares[piece_idx::w_queen]  = ret.check_squares[piece_idx::w_bishop] | ret.check_squares[piece_idx::w_rook];
+
+    // Look along the (empty-board) lines from the king for our sliders, with exactly one of our pieces in between. The squares
+    // between the slider and the king are where the rays from either end overlap when only the two of them are on the board.
+    const std::uint64_t king_bb { 1ULL << king_mb };
+    const std::uint64_t snipers_rook   { get_rook_attacked_squares_from_mailbox(0, king_mb)   & (bb.boards[set_piece_colour(piece_idx::w_rook,   is_black_to_play)] | bb.boards[set_piece_colour(piece_idx::w_queen, is_black_to_play)]) };
+    const std::uint64_t snipers_bishop { get_bishop_attacked_squares_from_mailbox(0, king_mb) & (bb.boards[set_piece_colour(piece_idx::w_bishop, is_black_to_play)] | bb.boards[set_piece_colour(piece_idx::w_queen, is_black_to_play)]) };
+
+    for (std::uint64_t snipers { snipers_rook }; snipers; snipers &= snipers-1)
+    {
+        const std::size_t sniper_mb { static_cast<std::size_t>(std::countr_zero(snipers)) };
+        const std::uint64_t between { get_rook_attacked_squares_from_mailbox(king_bb, sniper_mb) & get_rook_attacked_squares_from_mailbox(snipers & -snipers, king_mb) & pieces_bb };
+        if (std::has_single_bit(between) && (between & our_bb))
+            ret.discovered_blockers |= between;
+    }
+    for (std::uint64_t snipers { snipers_bishop }; snipers; snipers &= snipers-1)
+    {
+        const std::size_t sniper_mb { static_cast<std::size_t>(std::countr_zero(snipers)) };
+        const std::uint64_t between { get_bishop_attacked_squares_from_mailbox(king_bb, sniper_mb) & get_bishop_attacked_squares_from_mailbox(snipers & -snipers, king_mb) & pieces_bb };
+        if (std::has_single_bit(between) && (between & our_bb))
+            ret.discovered_blockers |= between;
+    }
+
+    return ret;
+}
+
+inline check_info get_check_info(const bitboard& bb) noexcept
+{
+    return bb.is_black_to_play() ? get_check_info<true>(bb) : get_check_info<false>(bb);
+}
+
+// Works out whether a pseudo-legal move of the side to play gives check. Castling and en-passent (which can uncover a check
+// through the captured pawn) are rare enough that we just make them on a copy of the board.
+inline bool gives_check(const bitboard& bb, const check_info& ci, std::uint32_t move) noexcept
+{
+    const bool is_black_to_play { bb.is_black_to_play() };
+    const std::uint64_t from_bb { 1ULL << move::make_decode_from_mb(move) };
+    const std::size_t to_mb     { move::make_decode_to_mb(move) };
+    const std::uint64_t to_bb   { 1ULL << to_mb };
+
+    if (move & (move::type::CASTLE_KS | move::type::CASTLE_QS | move::type::EN_PASSENT)) [[unlikely]]
+    {
+        bitboard bb_copy { bb };
+        const piece_idx piece { move::make_decode_piece_idx(move) };
+
+        bb_copy.boards[piece] ^= from_bb | to_bb;
+        if (move & move::type::EN_PASSENT)
+        {
+            const std::uint64_t capture_bb { is_black_to_play ? (to_bb << 8) : (to_bb >> 8) };
+            bb_copy.boards[is_black_to_play ? piece_idx::w_pawn : piece_idx::b_pawn] ^= capture_bb;
+            bb_copy.boards[is_black_to_play ? piece_idx::w_any  : piece_idx::b_any]  ^= capture_bb;
+            bb_copy.boards[is_black_to_play ? piece_idx::b_any  : piece_idx::w_any]  ^= from_bb | to_bb;
+        }
+        else
+        {
+            const std::uint64_t rank { is_black_to_play ? RANK_8 : RANK_1 };
+            const std::uint64_t rook_bb { (move & move::type::CASTLE_KS) ? (rank & (FILE_H | FILE_F)) : (rank & (FILE_A | FILE_D)) };
+            bb_copy.boards[set_piece_colour(piece_idx::w_rook, is_black_to_play)] ^= rook_bb;
+            bb_copy.boards[is_black_to_play ? piece_idx::b_any : piece_idx::w_any] ^= from_bb | to_bb | rook_bb;
+        }
+
+        return is_in_check(bb_copy, !is_black_to_play);
+    }
+
+    const std::uint64_t pieces_after_bb { ((bb.boards[piece_idx::w_any] | bb.boards[piece_idx::b_any]) ^ from_bb) | to_bb };
+    const std::uint64_t king_bb         { bb.boards[is_black_to_play ? piece_idx::w_king : piece_idx::b_king] };
+
+    // Direct checks. Promotions are rare, and the pawn leaving its square can open up the line to the king, so we just work out
+    // the attacks of the promoted piece from scratch.
+    if (move & move::type::PROMOTION) [[unlikely]]
+    {
+        std::uint64_t attacks {};
+        switch (move::make_decode_promotion(move) & 0x07)
+        {
+            case piece_idx::w_knight: attacks = get_knight_attacked_squares_from_mailbox(to_mb);                  break;
+            case piece_idx::w_bishop: attacks = get_bishop_attacked_squares_from_mailbox(pieces_after_bb, to_mb); break;
+            case piece_idx::w_rook:   attacks = get_rook_attacked_squares_from_mailbox(pieces_after_bb, to_mb);   break;
+            case piece_idx::w_queen:  attacks = get_queen_attacked_squares_from_mailbox(pieces_after_bb, to_mb);  break;
+            default: break;
+        }
+        if (attacks & king_bb)
+            return true;
+    }
+    else if (ci.check_squares[move::make_decode_piece_idx(move) & 0x07] & to_bb)
+    {
+        return true;
+    }
+
+    // Discovered checks - we just look along the lines from the king again if one of the blockers moved (it might have moved
+    // along the line).
+    if (ci.discovered_blockers & from_bb) [[unlikely]]
+    {
+        const std::size_t king_mb { static_cast<std::size_t>(std::countr_zero(king_bb)) };
+        const std::uint64_t rook_queen_bb   { (bb.boards[set_piece_colour(piece_idx::w_rook,   is_black_to_play)] | bb.boards[set_piece_colour(piece_idx::w_queen, is_black_to_play)]) & ~to_bb };
+        const std::uint64_t bishop_queen_bb { (bb.boards[set_piece_colour(piece_idx::w_bishop, is_black_to_play)] | bb.boards[set_piece_colour(piece_idx::w_queen, is_black_to_play)]) & ~to_bb };
+
+        return (get_rook_attacked_squares_from_mailbox(pieces_after_bb, king_mb) & rook_queen_bb)
+             | (get_bishop_attacked_squares_from_mailbox(pieces_after_bb, king_mb) & bishop_queen_bb);
+    }
+
+    return false;
+}
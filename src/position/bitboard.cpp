@@ -3,7 +3,7 @@
 #include "mailbox.hpp"
 
 bitboard::bitboard(const mailbox& mb)
-    : en_passent_bb(mb.en_passent_square.has_value() ? get_bitboard_mailbox_piece(*mb.en_passent_square) : 0), castling(mb.castling), ply_counter(mb.ply_counter), ply_50m(mb.ply_50m)
+    : squares(mb.squares), en_passent_bb(mb.en_passent_square.has_value() ? get_bitboard_mailbox_piece(*mb.en_passent_square) : 0), castling(mb.castling), ply_counter(mb.ply_counter), ply_50m(mb.ply_50m)
 {
     boards.fill(0);
     for (std::size_t i = 0; i < mb.squares.size(); i++)
@@ -51,6 +51,19 @@ bool bitboard::is_consistent() const noexcept
     if (b_pieces != boards[piece_idx::b_any])
         return false;
 
+    // Check the mailbox squares agree with the bitboards.
+    for (std::size_t mb = 0; mb < squares.size(); mb++)
+    {
+        const std::uint64_t mb_bb { 1ULL << mb };
+        if (squares[mb] == piece_idx::empty)
+        {
+            if ((w_pieces | b_pieces) & mb_bb)
+                return false;
+        }
+        else if (squares[mb] > piece_idx::b_queen || (squares[mb] & 0x07) > piece_idx::w_queen || !(boards[squares[mb]] & mb_bb))
+            return false;
+    }
+
     return true;
 }
 
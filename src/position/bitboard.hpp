@@ -30,6 +30,10 @@ struct bitboard
     constexpr std::span<const std::uint64_t> get_white_boards() const noexcept { return { &boards[piece_idx::w_pawn], 6 }; }
     constexpr std::span<const std::uint64_t> get_black_boards() const noexcept { return { &boards[piece_idx::b_pawn], 6 }; }
 
+    // The piece (or empty) on each square, kept in step with the bitboards so that looking up the piece on a square (e.g. the
+    // victim of a capture) doesn't need to scan through them.
+    std::array<piece_idx, 64> squares;
+
     // Contains at most a single one-bit, which is the en-passent target square created
     // by a possible double-pawn push on the last ply.
     std::uint64_t en_passent_bb;
@@ -57,6 +61,9 @@ struct bitboard
     constexpr piece_idx get_piece_type(std::uint64_t bb, bool no_empty = false) const noexcept;
     constexpr piece_idx get_piece_type_colour(std::uint64_t bb, bool is_black, bool no_empty = false) const noexcept;
 
+    // Gets the piece type on a particular square from the mailbox squares.
+    constexpr piece_idx get_piece_type_mb(std::size_t mb) const noexcept { return squares[mb]; }
+
     constexpr std::pair<piece_idx, std::uint64_t> get_least_valuable_piece(std::uint64_t bb, bool is_black) const noexcept;
 
     // Checks whether this is a king-and-pawn end-game.
@@ -76,6 +83,7 @@ struct bitboard
     bool operator==(const bitboard& other) const noexcept
     {
         return boards == other.boards
+            && squares       == other.squares
             && en_passent_bb == other.en_passent_bb
             && castling      == other.castling
             && ply_counter   == other.ply_counter
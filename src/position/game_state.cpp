@@ -7,20 +7,35 @@
 #include "zobrist_hash.hpp"
 #include "mailbox.hpp"
 
+#include <utility>
+#include <vector>
+
 void game_state::load(const bitboard& bb)
 {
     this->bb = bb;
-    hash = zobrist::hash_init(mailbox(bb));
+    const mailbox mb { bb };
+    hash      = zobrist::hash_init(mb);
+    pawn_hash = zobrist::pawn_hash_init(mb);
 
     position_history[0] = hash;
 
     piece_square_eval.init(bb);
+    if (nnue)
+        evaluation::nnue::refresh(nnue_accumulator, *nnue, bb);
+}
+
+void game_state::set_nnue(std::shared_ptr<const evaluation::nnue::network> net)
+{
+    nnue = std::move(net);
+    if (nnue)
+        evaluation::nnue::refresh(nnue_accumulator, *nnue, bb);
 }
 
 void game_state::reset()
 {
     bb = {};
     hash = {};
+    pawn_hash = {};
 
     prepare_new_search();
 }
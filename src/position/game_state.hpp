@@ -2,7 +2,9 @@
 
 #include "bitboard.hpp"
 #include "config.hpp"
+#include "details/hash_table.hpp"
 #include "details/pv_table.hpp"
+#include "details/relaxed_atomic.hpp"
 #include "details/km_table.hpp"
 #include "details/transposition_table.hpp"
 #include "details/history_heuristic.hpp"
@@ -10,6 +12,11 @@
 #include "evaluation/evaluate_king_safety.hpp"
 #include "evaluation/evaluate_pawn_structure.hpp"
 #include "evaluation/game_phase.hpp"
+#include "evaluation/nnue.hpp"
+
+#include <limits>
+#include <memory>
+#include <vector>
 
 // The main game state that is used in the search and evaluation. This includes the position itself (i.e. bitboard) as well
 // as other incrementally updated fields (e.g. hash).
@@ -24,9 +31,8 @@ struct game_state
     void reset();
 
     // Prepares the game-state for a new search (should be run before the ID call). This clears the various bits of
-    // serach-state, such as the transposition and principal-variation tables. This probably shouldn't be strictly
-    // necessary between moves, but not doing this means we play illegal moves for some reason (perhaps through
-    // hash-table collisions?).
+    // search-state, such as the principal-variation and killer tables, and ages the transposition table. Entries from
+    // previous searches are still used for cut-offs and move-ordering - the age only makes them the first to be replaced.
     void prepare_new_search();
 
     // The bitboard itself. We use a bitboard for obvious reasons.
@@ -35,11 +41,22 @@ struct game_state
     // Zobrist hash of the current position.
     std::uint64_t hash;
 
+    // Zobrist hash of just the pawns of the current position.
+    std::uint64_t pawn_hash;
+
     // The maximum theoretical game limit - this is a good-chunk of memory but we only have one of them so it's okay.
     static constexpr std::size_t MAX_GAME_LENGTH { 11798 };
 
-    // A boolean indicating when we must stop searching as soon as possible. All search algorithms must respect this.
-    bool stop_search;
+    // A boolean indicating when we must stop searching as soon as possible. All search algorithms must respect this. It's set
+    // from other threads (the UCI loop, or the main search thread for its helpers) while the search polls it.
+    details::relaxed_atomic<bool> stop_search;
+
+    // The number of nodes (counted by the statistics of the current iteration) after which the search stops itself, so a node
+    // budget only costs a comparison per node.
+    std::size_t node_limit { std::numeric_limits<std::size_t>::max() };
+
+    // The moves the search is restricted to at the root (e.g. UCI searchmoves), or empty to search all of them.
+    std::vector<std::uint32_t> root_moves;
 
     // History of hashes (LSB 32b) of previous positions indexed by the ply, as well as the ply of the last non-reversible
     // move.
@@ -48,11 +65,12 @@ struct game_state
     // The ply of our root node in our search.
     std::size_t root_ply;
 
-    // The main transposition table.
-    details::transposition_table tt;
+    // The main transposition table. This is shared between all copies of the game-state so that the helper threads of
+    // our lazy-SMP search all probe and store into the same table.
+    std::shared_ptr<details::transposition_table> tt { std::make_shared<details::transposition_table>() };
 
-    // The age of the current game-state. This is for things like invalidating hash lookups for when we need to consider
-    // new positions.
+    // The age of the current game-state, bumped for every search. This lets the transposition table prefer replacing
+    // entries left over from previous searches.
     std::uint8_t age;
 
     // PV table for collection.
@@ -68,9 +86,35 @@ struct game_state
     // this does is that it ensures only legal PVs are printed.
     std::span<const std::uint32_t> get_pv(std::size_t ply = 0) noexcept;
 
+    // The pawn hash table, caching the pawn-only part of the pawn-structure evaluation against the pawn hash. The pawn
+    // structure hardly ever changes between nodes, so this is small and almost always hits. Like the transposition table,
+    // this is shared between all copies of the game-state.
+    static constexpr std::size_t PAWN_HASH_TABLE_BYTES { 1ULL << 21 };
+    using pawn_hash_table_type = details::hash_table<evaluation::phased_eval>;
+    std::shared_ptr<pawn_hash_table_type> pawn_hash_table { std::make_shared<pawn_hash_table_type>(PAWN_HASH_TABLE_BYTES) };
+
+    // The evaluation cache, a direct-mapped (and lossy) cache of the static evaluation (from white's perspective, widened to
+    // a whole 64-bit word) against the hash of the position. Like the transposition table, this is shared between all
+    // copies of the game-state. The default size is in decimal MB like the UCI option, so setting it gives the same table.
+    static constexpr std::size_t EVAL_CACHE_BYTES_DEFAULT { 16ULL*1000000 };
+    using eval_cache_type = details::hash_table<std::int64_t>;
+    std::shared_ptr<eval_cache_type> eval_cache { std::make_shared<eval_cache_type>(EVAL_CACHE_BYTES_DEFAULT) };
+
     // Incrementally-updated evaluation parameters.
     evaluation::piece_square_eval piece_square_eval;
+
+    // The (optional) NNUE network, used instead of the hand-crafted evaluation when set, and its incrementally-updated
+    // accumulators. The network itself is read-only and shared between all copies of the game-state.
+    std::shared_ptr<const evaluation::nnue::network> nnue;
+    evaluation::nnue::accumulator nnue_accumulator;
+
+    // Sets (or clears with a null pointer) the NNUE network and refreshes the accumulators. Note that the evaluation cache
+    // should be cleared after changing the evaluation function.
+    void set_nnue(std::shared_ptr<const evaluation::nnue::network> net);
+
+    // The static evaluation (from white's perspective), and the middle-game and end-game scores it interpolates between.
     int evaluate() const noexcept;
+    evaluation::phased_eval evaluate_phased() const noexcept;
 
     // Determines whether the current position a draw by either the 50-move rule, or the three-fold-repetition rule - should
     // be called early on in search evaluation.
@@ -82,32 +126,46 @@ struct game_state
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
 
-inline int game_state::evaluate() const noexcept
+inline evaluation::phased_eval game_state::evaluate_phased() const noexcept
 {
-    int ret {};
-
     // The main bit of the evaluation is the piece-square evaluation that we calculate incrementally.
-    ret += piece_square_eval();
+    evaluation::phased_eval ret { piece_square_eval.mg, piece_square_eval.eg };
 
-    // Calculate pawn-structure on the go (might add a pawn-structure hash-table later on).
+    // The pawn-only part of the pawn-structure comes from the pawn hash table where we can, and the rest is calculated on
+    // the go. Note that an empty table entry is correct for the (zero) hash of no pawns at all.
     if constexpr (config::eval_ps)
-        ret += evaluation::interpolate_gp(
-            evaluation::evaluate_pawn_structure_mg(bb),
-            evaluation::evaluate_pawn_structure_eg(bb),
-            evaluation::evaluate_gp(bb)
-        );
+    {
+        evaluation::phased_eval pawns;
+        if (!config::pawn_hash || !pawn_hash_table->probe(pawn_hash, pawns))
+        {
+            pawns = evaluation::evaluate_pawn_structure_pawns(bb);
+            if constexpr (config::pawn_hash)
+                pawn_hash_table->store(pawn_hash, pawns);
+        }
+
+        ret += pawns + evaluation::evaluate_pawn_structure_pieces(bb);
+    }
 
     // Calculate king-safety on the go as well - this is also not particularly efficient.
     if constexpr (config::eval_ks)
-        ret += evaluation::interpolate_gp(
-            evaluation::evaluate_king_safety_mg(bb),
-            evaluation::evaluate_king_safety_eg(bb),
-            evaluation::evaluate_gp(bb)
-        );
+        ret += evaluation::evaluate_king_safety(bb);
 
     return ret;
 }
 
+inline int game_state::evaluate() const noexcept
+{
+    // The network scores from the perspective of the side to play.
+    if (nnue)
+    {
+        const int score { evaluation::nnue::evaluate(nnue_accumulator, *nnue, bb.is_black_to_play()) };
+        return bb.is_black_to_play() ? -score : score;
+    }
+
+    // Every term is summed up before interpolating just the once, using the incrementally-updated game-phase.
+    return evaluation::interpolate_gp(evaluate_phased(), piece_square_eval.gp);
+}
+
 inline bool game_state::is_repetition_draw() const noexcept
 {
     // These kinds of draws are impossible if we haven't even made enough non-reversible moves.
@@ -17,106 +17,165 @@ constexpr std::size_t MAX_MOVES_PER_POSITION { 218 };
 template <typename T>
 std::size_t generate_pseudo_legal_moves(const bitboard& bb, std::span<T> move_buf) noexcept;
 
+// Which of the pseudo-legal moves to generate. Loud moves are captures and queen / knight promotions, and quiet moves are
+// everything else (including rook / bishop promotions, even if they capture) - so the two together are all of the moves.
+enum class move_generation
+{
+    all,
+    loud,
+    quiet
+};
+
+template <typename T>
+std::size_t generate_pseudo_legal_loud_moves(const bitboard& bb, std::span<T> move_buf) noexcept;
+
+template <typename T>
+std::size_t generate_pseudo_legal_quiet_moves(const bitboard& bb, std::span<T> move_buf) noexcept;
+
+// Generates only the legal moves, so they can be made without checking legality. Instead of making each pseudo-legal move
+// to see if it leaves the king in check, we work out the checking pieces, the pinned pieces and the squares attacked by the
+// opponent once for the position, and use them to mask each piece's moves. When in check we only generate the evasions.
 template <typename T>
+std::size_t generate_legal_moves(const bitboard& bb, std::span<T> move_buf) noexcept;
+
+// Each of the generators is also available with the side to play given at compile time, e.g.
+//     generate_legal_moves<true>(bb, move_buf)
+// generates black's moves. Every colour-dependent choice (piece indices, pawn directions, promotion and castling ranks) is
+// then fixed when the generator is compiled, which is what the plain versions use after checking the side to play once.
+// Callers that alternate colours down the tree (like perft) can carry the side in their own template parameter instead.
+template <bool Black, typename T>
+std::size_t generate_pseudo_legal_moves(const bitboard& bb, std::span<T> move_buf) noexcept;
+
+template <bool Black, typename T>
 std::size_t generate_pseudo_legal_loud_moves(const bitboard& bb, std::span<T> move_buf) noexcept;
 
+template <bool Black, typename T>
+std::size_t generate_pseudo_legal_quiet_moves(const bitboard& bb, std::span<T> move_buf) noexcept;
+
+template <bool Black, typename T>
+std::size_t generate_legal_moves(const bitboard& bb, std::span<T> move_buf) noexcept;
+
+// Checks whether an arbitrary move (ignoring its info bits) is one that generate_pseudo_legal_moves would generate for this
+// position, without generating any moves. This is for moves from outside of this position's move-list, e.g. a hash move
+// that might really be from a colliding position, so we can safely play them before (or instead of) generating moves.
+bool is_pseudo_legal(const bitboard& bb, std::uint32_t move) noexcept;
+
 // ####################################
 // IMPLEMENTATION
 // ####################################
 
+#include "position/attacks.hpp"
 #include "position/move.hpp"
 
 namespace details
 {
 
+// Adds a pawn move to each of the target squares, where the pawns are all moving in the same direction - so each from-square
+// is the same offset back from its target square. This lets us generate the moves of every pawn at once by shifting the
+// whole pawn bitboard, rather than looking up the moves of each pawn in turn.
 template <typename T>
-inline std::size_t get_pawn_moves(const bitboard& bb, std::span<T> move_buf, bool loud_only = false) noexcept
+inline std::size_t add_pawn_moves(std::span<T> move_buf, std::uint64_t targets, int offset, piece_idx piece, std::uint32_t type) noexcept
 {
     std::size_t ret {};
 
-    const bool is_black_to_play { bb.is_black_to_play() };
-    const piece_idx to_move_idx { is_black_to_play ? piece_idx::b_pawn : piece_idx::w_pawn };
-    const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
-    const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
-    const std::uint64_t all_pieces { to_move_pieces | opponent_pieces };
+    for (; targets; targets &= targets-1)
+    {
+        const std::size_t to_mb { static_cast<std::size_t>(std::countr_zero(targets)) };
+        move_buf[ret++] = move::make_encode(to_mb - offset, to_mb, piece) | type;
+    }
+
+    return ret;
+}
+
+// As above, but for moves to the last rank, adding each of the promotions.
+template <typename T>
+inline std::size_t add_pawn_promotions(std::span<T> move_buf, std::uint64_t targets, int offset, piece_idx piece, std::uint32_t type, move_generation generation, bool is_black_to_play) noexcept
+{
+    std::size_t ret {};
 
-    for (std::uint64_t to_move_pawns { bb.boards[to_move_idx] }; to_move_pawns; )
+    for (; targets; targets &= targets-1)
     {
-        const std::uint64_t pawn_bitboard { ls1b_isolate(to_move_pawns) };
-        const std::size_t pawn_mailbox = std::countr_zero(pawn_bitboard);
+        const std::size_t to_mb { static_cast<std::size_t>(std::countr_zero(targets)) };
+        const std::uint32_t move { move::make_encode(to_mb - offset, to_mb, piece) | type | move::type::PROMOTION };
 
-        // Handle attacking moves.
-        for (std::uint64_t attacks { (is_black_to_play ? get_black_pawn_all_attacked_squares_from_mailbox(pawn_mailbox) : get_white_pawn_all_attacked_squares_from_mailbox(pawn_mailbox)) & (opponent_pieces | bb.en_passent_bb) }; attacks; )
+        // Only consider queen and knight promotions loud - somehow rook and bishop promotions seem quiet to me...
+        if (generation != move_generation::quiet)
         {
-            const std::uint64_t attack { ls1b_isolate(attacks) };
+            move_buf[ret++] = move | move::make_encode_promotion(set_piece_colour(piece_idx::w_queen,  is_black_to_play));
+            move_buf[ret++] = move | move::make_encode_promotion(set_piece_colour(piece_idx::w_knight, is_black_to_play));
+        }
+        if (generation != move_generation::loud)
+        {
+            move_buf[ret++] = move | move::make_encode_promotion(set_piece_colour(piece_idx::w_rook,   is_black_to_play));
+            move_buf[ret++] = move | move::make_encode_promotion(set_piece_colour(piece_idx::w_bishop, is_black_to_play));
+        }
+    }
 
-            {
-                const std::uint32_t move { move::make_encode(pawn_mailbox, std::countr_zero(attack), to_move_idx) | move::type::CAPTURE };
-
-                // Test if this pawn move will result in promotion.
-                if (attack & (is_black_to_play ? RANK_1 : RANK_8)) [[unlikely]]
-                {
-                    // Only consider queen and knight promotions loud - somehow rook and bishop promotions seem quiet to me...
-                    move_buf[ret++] = move | move::type::PROMOTION | move::make_encode_promotion(set_piece_colour(piece_idx::w_queen,  is_black_to_play));
-                    move_buf[ret++] = move | move::type::PROMOTION | move::make_encode_promotion(set_piece_colour(piece_idx::w_knight, is_black_to_play));
-                    if (!loud_only)
-                    {
-                        move_buf[ret++] = move | move::type::PROMOTION | move::make_encode_promotion(set_piece_colour(piece_idx::w_rook,   is_black_to_play));
-                        move_buf[ret++] = move | move::type::PROMOTION | move::make_encode_promotion(set_piece_colour(piece_idx::w_bishop, is_black_to_play));
-                    }
-                }
-                else
-                {
-                    // Remember to set the en-passent meta-bit if necessary (note this is mutually-exclusive with promotion).
-                    move_buf[ret++] = move | ((attack & bb.en_passent_bb) ? move::type::EN_PASSENT : 0);
-                }
-            }
+    return ret;
+}
 
-            attacks ^= attack;
-        }
+// The offsets from a pawn to the target squares of each of its moves.
+template <bool Black> constexpr int pawn_push_offset { Black ? -8 : 8 };
+template <bool Black> constexpr int pawn_west_offset { Black ? -9 : 7 };
+template <bool Black> constexpr int pawn_east_offset { Black ? -7 : 9 };
 
-        // Handle single pawn pushes.
-        if (std::uint64_t push { is_black_to_play ? get_black_pawn_single_push_squares_from_mailbox(pawn_mailbox, ~all_pieces) : get_white_pawn_single_push_squares_from_mailbox(pawn_mailbox, ~all_pieces) }; push)
-        {
-            const std::uint32_t move { move::make_encode(pawn_mailbox, std::countr_zero(push), to_move_idx) | move::type::PAWN_PUSH_SINGLE };
+template <bool Black, typename T>
+inline std::size_t get_pawn_moves(const bitboard& bb, std::span<T> move_buf, move_generation type = move_generation::all) noexcept
+{
+    std::size_t ret {};
 
-            // Test if this pawn move will result in promotion.
-            if (push & (is_black_to_play ? RANK_1 : RANK_8)) [[unlikely]]
-            {
-                // Only consider queen and knight promotions loud - somehow rook and bishop promotions seem quiet to me...
-                move_buf[ret++] = move | move::type::PROMOTION | move::make_encode_promotion(set_piece_colour(piece_idx::w_queen,  is_black_to_play));
-                move_buf[ret++] = move | move::type::PROMOTION | move::make_encode_promotion(set_piece_colour(piece_idx::w_knight, is_black_to_play));
-                if (!loud_only)
-                {
-                    move_buf[ret++] = move | move::type::PROMOTION | move::make_encode_promotion(set_piece_colour(piece_idx::w_rook,   is_black_to_play));
-                    move_buf[ret++] = move | move::type::PROMOTION | move::make_encode_promotion(set_piece_colour(piece_idx::w_bishop, is_black_to_play));
-                }
-            }
-            else if (!loud_only)
-            {
-                move_buf[ret++] = move;
-            }
-        }
+    constexpr bool is_black_to_play { Black };
+    constexpr piece_idx to_move_idx { is_black_to_play ? piece_idx::b_pawn : piece_idx::w_pawn };
+    const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
+    const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
+    const std::uint64_t all_pieces { to_move_pieces | opponent_pieces };
+    constexpr std::uint64_t last_rank { is_black_to_play ? RANK_1 : RANK_8 };
 
-        // Handle double pawn pushes.
-        if (const std::uint64_t push { is_black_to_play ? get_black_pawn_double_push_squares_from_mailbox(pawn_mailbox, ~all_pieces) : get_white_pawn_double_push_squares_from_mailbox(pawn_mailbox, ~all_pieces) }; !loud_only && push)
+    const std::uint64_t pawns { bb.boards[to_move_idx] };
+    const std::uint64_t west_attacks { is_black_to_play ? get_black_pawn_west_attacked_squares_from_bitboard(pawns) : get_white_pawn_west_attacked_squares_from_bitboard(pawns) };
+    const std::uint64_t east_attacks { is_black_to_play ? get_black_pawn_east_attacked_squares_from_bitboard(pawns) : get_white_pawn_east_attacked_squares_from_bitboard(pawns) };
+    const std::uint64_t single_pushes { is_black_to_play ? get_black_pawn_single_push_squares_from_bitboard(pawns, ~all_pieces) : get_white_pawn_single_push_squares_from_bitboard(pawns, ~all_pieces) };
+
+    // Handle attacking moves.
+    if (type != move_generation::quiet)
+    {
+        ret += add_pawn_moves(move_buf.subspan(ret), west_attacks & opponent_pieces & ~last_rank, pawn_west_offset<Black>, to_move_idx, move::type::CAPTURE);
+        ret += add_pawn_moves(move_buf.subspan(ret), east_attacks & opponent_pieces & ~last_rank, pawn_east_offset<Black>, to_move_idx, move::type::CAPTURE);
+
+        // Remember to set the en-passent meta-bit if necessary (note this is mutually-exclusive with promotion).
+        if (bb.en_passent_bb) [[unlikely]]
         {
-            const std::uint32_t move { move::make_encode(pawn_mailbox, std::countr_zero(push), to_move_idx) | move::type::PAWN_PUSH_DOUBLE };
-            move_buf[ret++] = move;
+            ret += add_pawn_moves(move_buf.subspan(ret), west_attacks & bb.en_passent_bb, pawn_west_offset<Black>, to_move_idx, move::type::CAPTURE | move::type::EN_PASSENT);
+            ret += add_pawn_moves(move_buf.subspan(ret), east_attacks & bb.en_passent_bb, pawn_east_offset<Black>, to_move_idx, move::type::CAPTURE | move::type::EN_PASSENT);
         }
+    }
 
-        to_move_pawns ^= pawn_bitboard;
+    // Handle promotions (both attacking moves and pushes).
+    if ((west_attacks | east_attacks | single_pushes) & last_rank) [[unlikely]]
+    {
+        ret += add_pawn_promotions(move_buf.subspan(ret), west_attacks & opponent_pieces & last_rank, pawn_west_offset<Black>, to_move_idx, move::type::CAPTURE,          type, is_black_to_play);
+        ret += add_pawn_promotions(move_buf.subspan(ret), east_attacks & opponent_pieces & last_rank, pawn_east_offset<Black>, to_move_idx, move::type::CAPTURE,          type, is_black_to_play);
+        ret += add_pawn_promotions(move_buf.subspan(ret), single_pushes & last_rank,                  pawn_push_offset<Black>, to_move_idx, move::type::PAWN_PUSH_SINGLE, type, is_black_to_play);
+    }
+
+    // Handle single and double pawn pushes.
+    if (type != move_generation::loud)
+    {
+        const std::uint64_t double_pushes { is_black_to_play ? get_black_pawn_double_push_squares_from_bitboard(pawns, ~all_pieces) : get_white_pawn_double_push_squares_from_bitboard(pawns, ~all_pieces) };
+
+        ret += add_pawn_moves(move_buf.subspan(ret), single_pushes & ~last_rank, pawn_push_offset<Black>,   to_move_idx, move::type::PAWN_PUSH_SINGLE);
+        ret += add_pawn_moves(move_buf.subspan(ret), double_pushes,              2*pawn_push_offset<Black>, to_move_idx, move::type::PAWN_PUSH_DOUBLE);
     }
 
     return ret;
 }
 
-template <typename T>
-inline std::size_t get_king_moves(const bitboard& bb, std::span<T> move_buf, bool loud_only = false) noexcept
+template <bool Black, typename T>
+inline std::size_t get_king_moves(const bitboard& bb, std::span<T> move_buf, move_generation type = move_generation::all) noexcept
 {
     std::size_t ret {};
 
-    const bool is_black_to_play { bb.is_black_to_play() };
+    constexpr bool is_black_to_play { Black };
     const piece_idx to_move_idx { is_black_to_play ? piece_idx::b_king : piece_idx::w_king };
     const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
     const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
@@ -127,9 +186,9 @@ inline std::size_t get_king_moves(const bitboard& bb, std::span<T> move_buf, boo
     const std::size_t king_mailbox = std::countr_zero(king_bitboard);
 
     // Generate pseudo-legal castling moves (we test for castling-through-check legality in make_move).
-    if (!loud_only)
+    if (type != move_generation::loud)
     {
-        if (is_black_to_play)
+        if constexpr (is_black_to_play)
         {
             constexpr std::size_t from_square { std::countr_zero(FILE_E & RANK_8) };
 
@@ -175,12 +234,12 @@ inline std::size_t get_king_moves(const bitboard& bb, std::span<T> move_buf, boo
         const std::uint64_t attack { ls1b_isolate(attacks) };
 
         const bool is_capture = attack & opponent_pieces;
-        if (is_capture)
+        if (is_capture && type != move_generation::quiet)
         {
             const std::uint32_t move { move::make_encode(king_mailbox, std::countr_zero(attack), to_move_idx) | move::type::CAPTURE };
             move_buf[ret++] = move;
         }
-        else if (!loud_only && !is_capture)
+        else if (type != move_generation::loud && !is_capture)
         {
             const std::uint32_t move { move::make_encode(king_mailbox, std::countr_zero(attack), to_move_idx) };
             move_buf[ret++] = move;
@@ -192,12 +251,12 @@ inline std::size_t get_king_moves(const bitboard& bb, std::span<T> move_buf, boo
     return ret;
 }
 
-template <typename T>
-inline std::size_t get_knight_moves(const bitboard& bb, std::span<T> move_buf, bool loud_only = false) noexcept
+template <bool Black, typename T>
+inline std::size_t get_knight_moves(const bitboard& bb, std::span<T> move_buf, move_generation type = move_generation::all) noexcept
 {
     std::size_t ret {};
 
-    const bool is_black_to_play { bb.is_black_to_play() };
+    constexpr bool is_black_to_play { Black };
     const piece_idx to_move_idx { is_black_to_play ? piece_idx::b_knight : piece_idx::w_knight };
     const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
     const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
@@ -212,12 +271,12 @@ inline std::size_t get_knight_moves(const bitboard& bb, std::span<T> move_buf, b
             const std::uint64_t attack { ls1b_isolate(attacks) };
 
             const bool is_capture = attack & opponent_pieces;
-            if (is_capture)
+            if (is_capture && type != move_generation::quiet)
             {
                 const std::uint32_t move { move::make_encode(knight_mailbox, std::countr_zero(attack), to_move_idx) | move::type::CAPTURE };
                 move_buf[ret++] = move;
             }
-            else if (!loud_only && !is_capture)
+            else if (type != move_generation::loud && !is_capture)
             {
                 const std::uint32_t move { move::make_encode(knight_mailbox, std::countr_zero(attack), to_move_idx) };
                 move_buf[ret++] = move;
@@ -232,12 +291,12 @@ inline std::size_t get_knight_moves(const bitboard& bb, std::span<T> move_buf, b
     return ret;
 }
 
-template <typename T>
-inline std::size_t get_bishop_moves(const bitboard& bb, std::span<T> move_buf, bool loud_only = false) noexcept
+template <bool Black, typename T>
+inline std::size_t get_bishop_moves(const bitboard& bb, std::span<T> move_buf, move_generation type = move_generation::all) noexcept
 {
     std::size_t ret {};
 
-    const bool is_black_to_play { bb.is_black_to_play() };
+    constexpr bool is_black_to_play { Black };
     const piece_idx to_move_idx { is_black_to_play ? piece_idx::b_bishop : piece_idx::w_bishop };
     const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
     const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
@@ -253,12 +312,12 @@ inline std::size_t get_bishop_moves(const bitboard& bb, std::span<T> move_buf, b
             const std::uint64_t attack { ls1b_isolate(attacks) };
 
             const bool is_capture = attack & opponent_pieces;
-            if (is_capture)
+            if (is_capture && type != move_generation::quiet)
             {
                 const std::uint32_t move { move::make_encode(bishop_mailbox, std::countr_zero(attack), to_move_idx) | move::type::CAPTURE };
                 move_buf[ret++] = move;
             }
-            else if (!loud_only && !is_capture)
+            else if (type != move_generation::loud && !is_capture)
             {
                 const std::uint32_t move { move::make_encode(bishop_mailbox, std::countr_zero(attack), to_move_idx) };
                 move_buf[ret++] = move;
@@ -273,12 +332,12 @@ inline std::size_t get_bishop_moves(const bitboard& bb, std::span<T> move_buf, b
     return ret;
 }
 
-template <typename T>
-inline std::size_t get_rook_moves(const bitboard& bb, std::span<T> move_buf, bool loud_only = false) noexcept
+template <bool Black, typename T>
+inline std::size_t get_rook_moves(const bitboard& bb, std::span<T> move_buf, move_generation type = move_generation::all) noexcept
 {
     std::size_t ret {};
 
-    const bool is_black_to_play { bb.is_black_to_play() };
+    constexpr bool is_black_to_play { Black };
     const piece_idx to_move_idx { is_black_to_play ? piece_idx::b_rook : piece_idx::w_rook };
     const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
     const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
@@ -294,12 +353,12 @@ inline std::size_t get_rook_moves(const bitboard& bb, std::span<T> move_buf, boo
             const std::uint64_t attack { ls1b_isolate(attacks) };
 
             const bool is_capture = attack & opponent_pieces;
-            if (is_capture)
+            if (is_capture && type != move_generation::quiet)
             {
                 const std::uint32_t move { move::make_encode(rook_mailbox, std::countr_zero(attack), to_move_idx) | move::type::CAPTURE };
                 move_buf[ret++] = move;
             }
-            else if (!loud_only && !is_capture)
+            else if (type != move_generation::loud && !is_capture)
             {
                 const std::uint32_t move { move::make_encode(rook_mailbox, std::countr_zero(attack), to_move_idx) };
                 move_buf[ret++] = move;
@@ -314,12 +373,12 @@ inline std::size_t get_rook_moves(const bitboard& bb, std::span<T> move_buf, boo
     return ret;
 }
 
-template <typename T>
-inline std::size_t get_queen_moves(const bitboard& bb, std::span<T> move_buf, bool loud_only = false) noexcept
+template <bool Black, typename T>
+inline std::size_t get_queen_moves(const bitboard& bb, std::span<T> move_buf, move_generation type = move_generation::all) noexcept
 {
     std::size_t ret {};
 
-    const bool is_black_to_play { bb.is_black_to_play() };
+    constexpr bool is_black_to_play { Black };
     const piece_idx to_move_idx { is_black_to_play ? piece_idx::b_queen : piece_idx::w_queen };
     const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
     const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
@@ -335,12 +394,12 @@ inline std::size_t get_queen_moves(const bitboard& bb, std::span<T> move_buf, bo
             const std::uint64_t attack { ls1b_isolate(attacks) };
 
             const bool is_capture = attack & opponent_pieces;
-            if (is_capture)
+            if (is_capture && type != move_generation::quiet)
             {
                 const std::uint32_t move { move::make_encode(queen_mailbox, std::countr_zero(attack), to_move_idx) | move::type::CAPTURE };
                 move_buf[ret++] = move;
             }
-            else if (!loud_only && !is_capture)
+            else if (type != move_generation::loud && !is_capture)
             {
                 const std::uint32_t move { move::make_encode(queen_mailbox, std::countr_zero(attack), to_move_idx) };
                 move_buf[ret++] = move;
@@ -357,32 +416,461 @@ inline std::size_t get_queen_moves(const bitboard& bb, std::span<T> move_buf, bo
 
 }
 
-template <typename T>
+template <bool Black, typename T>
 inline std::size_t generate_pseudo_legal_moves(const bitboard& bb, std::span<T> move_buf) noexcept
 {
     std::size_t ret {};
 
-    ret += details::get_pawn_moves(bb,   move_buf.subspan(ret));
-    ret += details::get_king_moves(bb,   move_buf.subspan(ret));
-    ret += details::get_knight_moves(bb, move_buf.subspan(ret));
-    ret += details::get_bishop_moves(bb, move_buf.subspan(ret));
-    ret += details::get_rook_moves(bb,   move_buf.subspan(ret));
-    ret += details::get_queen_moves(bb,  move_buf.subspan(ret));
+    ret += details::get_pawn_moves<Black>(bb,   move_buf.subspan(ret));
+    ret += details::get_king_moves<Black>(bb,   move_buf.subspan(ret));
+    ret += details::get_knight_moves<Black>(bb, move_buf.subspan(ret));
+    ret += details::get_bishop_moves<Black>(bb, move_buf.subspan(ret));
+    ret += details::get_rook_moves<Black>(bb,   move_buf.subspan(ret));
+    ret += details::get_queen_moves<Black>(bb,  move_buf.subspan(ret));
+
+    return ret;
+}
+
+template <bool Black, typename T>
+inline std::size_t generate_pseudo_legal_loud_moves(const bitboard& bb, std::span<T> move_buf) noexcept
+{
+    std::size_t ret {};
+
+    ret += details::get_pawn_moves<Black>(bb,   move_buf.subspan(ret), move_generation::loud);
+    ret += details::get_king_moves<Black>(bb,   move_buf.subspan(ret), move_generation::loud);
+    ret += details::get_knight_moves<Black>(bb, move_buf.subspan(ret), move_generation::loud);
+    ret += details::get_bishop_moves<Black>(bb, move_buf.subspan(ret), move_generation::loud);
+    ret += details::get_rook_moves<Black>(bb,   move_buf.subspan(ret), move_generation::loud);
+    ret += details::get_queen_moves<Black>(bb,  move_buf.subspan(ret), move_generation::loud);
+
+    return ret;
+}
+
+template <bool Black, typename T>
+inline std::size_t generate_pseudo_legal_quiet_moves(const bitboard& bb, std::span<T> move_buf) noexcept
+{
+    std::size_t ret {};
+
+    ret += details::get_pawn_moves<Black>(bb,   move_buf.subspan(ret), move_generation::quiet);
+    ret += details::get_king_moves<Black>(bb,   move_buf.subspan(ret), move_generation::quiet);
+    ret += details::get_knight_moves<Black>(bb, move_buf.subspan(ret), move_generation::quiet);
+    ret += details::get_bishop_moves<Black>(bb, move_buf.subspan(ret), move_generation::quiet);
+    ret += details::get_rook_moves<Black>(bb,   move_buf.subspan(ret), move_generation::quiet);
+    ret += details::get_queen_moves<Black>(bb,  move_buf.subspan(ret), move_generation::quiet);
 
     return ret;
 }
 
+template <typename T>
+inline std::size_t generate_pseudo_legal_moves(const bitboard& bb, std::span<T> move_buf) noexcept
+{
+    return bb.is_black_to_play() ? generate_pseudo_legal_moves<true>(bb, move_buf) : generate_pseudo_legal_moves<false>(bb, move_buf);
+}
+
 template <typename T>
 inline std::size_t generate_pseudo_legal_loud_moves(const bitboard& bb, std::span<T> move_buf) noexcept
+{
+    return bb.is_black_to_play() ? generate_pseudo_legal_loud_moves<true>(bb, move_buf) : generate_pseudo_legal_loud_moves<false>(bb, move_buf);
+}
+
+template <typename T>
+inline std::size_t generate_pseudo_legal_quiet_moves(const bitboard& bb, std::span<T> move_buf) noexcept
+{
+    return bb.is_black_to_play() ? generate_pseudo_legal_quiet_moves<true>(bb, move_buf) : generate_pseudo_legal_quiet_moves<false>(bb, move_buf);
+}
+
+namespace details
+{
+
+// The squares strictly between two squares that share a rank, file or diagonal (and none if they don't).
+inline std::uint64_t get_between_squares(std::size_t mb_a, std::size_t mb_b) noexcept
+{
+    const std::uint64_t bb_a { 1ULL << mb_a };
+    const std::uint64_t bb_b { 1ULL << mb_b };
+
+    // With only the two pieces on the board, the squares between them are the ones both of them attack along the line.
+    if (get_rook_xrayed_squares_from_mailbox(mb_a) & bb_b)
+        return get_rook_attacked_squares_from_mailbox(bb_b, mb_a) & get_rook_attacked_squares_from_mailbox(bb_a, mb_b);
+    if (get_bishop_xrayed_squares_from_mailbox(mb_a) & bb_b)
+        return get_bishop_attacked_squares_from_mailbox(bb_b, mb_a) & get_bishop_attacked_squares_from_mailbox(bb_a, mb_b);
+    return 0;
+}
+
+// All of the squares attacked by one side, with sliders stopping at the given pieces.
+inline std::uint64_t get_attacked_squares(const bitboard& bb, bool is_black, std::uint64_t pieces_bb) noexcept
+{
+    const std::uint64_t pawns_bb { bb.boards[set_piece_colour(piece_idx::w_pawn, is_black)] };
+    std::uint64_t ret { is_black ? get_black_pawn_all_attacked_squares_from_bitboard(pawns_bb) : get_white_pawn_all_attacked_squares_from_bitboard(pawns_bb) };
+
+    ret |= get_king_attacked_squares_from_mailbox(std::countr_zero(bb.boards[set_piece_colour(piece_idx::w_king, is_black)]));
+    for (std::uint64_t knights { bb.boards[set_piece_colour(piece_idx::w_knight, is_black)] }; knights; knights &= knights-1)
+        ret |= get_knight_attacked_squares_from_mailbox(std::countr_zero(knights));
+
+    const std::uint64_t queens_bb { bb.boards[set_piece_colour(piece_idx::w_queen, is_black)] };
+    for (std::uint64_t sliders { bb.boards[set_piece_colour(piece_idx::w_bishop, is_black)] | queens_bb }; sliders; sliders &= sliders-1)
+        ret |= get_bishop_attacked_squares_from_mailbox(pieces_bb, std::countr_zero(sliders));
+    for (std::uint64_t sliders { bb.boards[set_piece_colour(piece_idx::w_rook, is_black)] | queens_bb }; sliders; sliders &= sliders-1)
+        ret |= get_rook_attacked_squares_from_mailbox(pieces_bb, std::countr_zero(sliders));
+
+    return ret;
+}
+
+// Everything the legal move generator needs to know about checks and pins, worked out once per position.
+struct legal_move_masks
+{
+    // The opponent pieces giving check.
+    std::uint64_t checkers;
+
+    // The squares our pieces (other than the king) may move to - anywhere but onto our own pieces when not in check, and
+    // otherwise only to capture or block the checking piece.
+    std::uint64_t targets;
+
+    // The lines from our king to each opponent slider pinning one of our pieces (including the pinning piece), split by
+    // direction. A pinned piece has to stay on its line, and can't reach any other pin line of the same direction.
+    std::uint64_t pins_orthogonal;
+    std::uint64_t pins_diagonal;
+
+    // The squares the opponent attacks with our king off the board, so that the king can't step back along a checking line.
+    std::uint64_t king_danger;
+};
+
+template <bool Black>
+inline legal_move_masks get_legal_move_masks(const bitboard& bb) noexcept
+{
+    constexpr bool is_black_to_play     { Black };
+    const std::uint64_t to_move_pieces  { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
+    const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
+    const std::uint64_t all_pieces      { to_move_pieces | opponent_pieces };
+
+    const std::uint64_t king_bb { bb.boards[set_piece_colour(piece_idx::w_king, is_black_to_play)] };
+    const std::size_t king_mb   { static_cast<std::size_t>(std::countr_zero(king_bb)) };
+
+    const std::uint64_t opponent_queens      { bb.boards[set_piece_colour(piece_idx::w_queen,  !is_black_to_play)] };
+    const std::uint64_t opponent_orthogonals { bb.boards[set_piece_colour(piece_idx::w_rook,   !is_black_to_play)] | opponent_queens };
+    const std::uint64_t opponent_diagonals   { bb.boards[set_piece_colour(piece_idx::w_bishop, !is_black_to_play)] | opponent_queens };
+
+    legal_move_masks ret {};
+
+    ret.checkers = is_black_to_play ? get_attackers_white(bb, king_mb) : get_attackers_black(bb, king_mb);
+    ret.targets  = ~to_move_pieces;
+    if (ret.checkers)
+        ret.targets &= ret.checkers | get_between_squares(king_mb, std::countr_zero(ret.checkers));
+
+    // Look along the (empty-board) lines from our king for opponent sliders with exactly one piece in between, which is ours.
+    for (std::uint64_t snipers { get_rook_xrayed_squares_from_mailbox(king_mb) & opponent_orthogonals }; snipers; snipers &= snipers-1)
+    {
+        const std::size_t sniper_mb { static_cast<std::size_t>(std::countr_zero(snipers)) };
+        const std::uint64_t between { get_between_squares(king_mb, sniper_mb) };
+        if (const std::uint64_t blockers { between & all_pieces }; std::has_single_bit(blockers) && (blockers & to_move_pieces))
+            ret.pins_orthogonal |= between | (1ULL << sniper_mb);
+    }
+    for (std::uint64_t snipers { get_bishop_xrayed_squares_from_mailbox(king_mb) & opponent_diagonals }; snipers; snipers &= snipers-1)
+    {
+        const std::size_t sniper_mb { static_cast<std::size_t>(std::countr_zero(snipers)) };
+        const std::uint64_t between { get_between_squares(king_mb, sniper_mb) };
+        if (const std::uint64_t blockers { between & all_pieces }; std::has_single_bit(blockers) && (blockers & to_move_pieces))
+            ret.pins_diagonal |= between | (1ULL << sniper_mb);
+    }
+
+    ret.king_danger = get_attacked_squares(bb, !is_black_to_play, all_pieces ^ king_bb);
+
+    return ret;
+}
+
+// Adds a move from a square to each of the target squares, which have already been masked down to the legal ones.
+template <typename T>
+inline std::size_t add_legal_moves(std::span<T> move_buf, std::size_t from_mb, piece_idx piece, std::uint64_t targets, std::uint64_t opponent_pieces) noexcept
+{
+    std::size_t ret {};
+
+    for (; targets; targets &= targets-1)
+    {
+        const std::size_t to_mb { static_cast<std::size_t>(std::countr_zero(targets)) };
+        move_buf[ret++] = move::make_encode(from_mb, to_mb, piece) | ((opponent_pieces & (1ULL << to_mb)) ? move::type::CAPTURE : 0);
+    }
+
+    return ret;
+}
+
+// Pawn moves are generated set-wise, as in the pseudo-legal generator. A pinned pawn has to stay on its pin line - captures
+// are diagonal, so can only be made by a pawn pinned diagonally (and not one pinned orthogonally), and pushes are orthogonal,
+// so can only be made by a pawn pinned orthogonally (on its file). Either way, the pawn can't reach any other pin line of the
+// same direction, so it's enough to mask its moves with all of them.
+template <bool Black, typename T>
+inline std::size_t get_legal_pawn_moves(const bitboard& bb, std::span<T> move_buf, const legal_move_masks& masks) noexcept
+{
+    std::size_t ret {};
+
+    constexpr bool is_black_to_play { Black };
+    constexpr piece_idx to_move_idx { is_black_to_play ? piece_idx::b_pawn : piece_idx::w_pawn };
+    const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
+    const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
+    const std::uint64_t all_pieces { to_move_pieces | opponent_pieces };
+    constexpr std::uint64_t last_rank { is_black_to_play ? RANK_1 : RANK_8 };
+
+    const std::uint64_t pawns { bb.boards[to_move_idx] };
+    const std::uint64_t unpinned_pawns { pawns & ~(masks.pins_orthogonal | masks.pins_diagonal) };
+
+    std::uint64_t west_attacks  { (is_black_to_play ? get_black_pawn_west_attacked_squares_from_bitboard(unpinned_pawns) : get_white_pawn_west_attacked_squares_from_bitboard(unpinned_pawns)) & opponent_pieces & masks.targets };
+    std::uint64_t east_attacks  { (is_black_to_play ? get_black_pawn_east_attacked_squares_from_bitboard(unpinned_pawns) : get_white_pawn_east_attacked_squares_from_bitboard(unpinned_pawns)) & opponent_pieces & masks.targets };
+
+    // Note a double push can block a check even if the single push can't, so the targets only mask the final squares.
+    std::uint64_t single_pushes { (is_black_to_play ? get_black_pawn_single_push_squares_from_bitboard(unpinned_pawns, ~all_pieces) : get_white_pawn_single_push_squares_from_bitboard(unpinned_pawns, ~all_pieces)) & masks.targets };
+    std::uint64_t double_pushes { (is_black_to_play ? get_black_pawn_double_push_squares_from_bitboard(unpinned_pawns, ~all_pieces) : get_white_pawn_double_push_squares_from_bitboard(unpinned_pawns, ~all_pieces)) & masks.targets };
+
+    if (const std::uint64_t pinned_pawns { pawns & masks.pins_diagonal }; pinned_pawns) [[unlikely]]
+    {
+        west_attacks |= (is_black_to_play ? get_black_pawn_west_attacked_squares_from_bitboard(pinned_pawns) : get_white_pawn_west_attacked_squares_from_bitboard(pinned_pawns)) & opponent_pieces & masks.targets & masks.pins_diagonal;
+        east_attacks |= (is_black_to_play ? get_black_pawn_east_attacked_squares_from_bitboard(pinned_pawns) : get_white_pawn_east_attacked_squares_from_bitboard(pinned_pawns)) & opponent_pieces & masks.targets & masks.pins_diagonal;
+    }
+    if (const std::uint64_t pinned_pawns { pawns & masks.pins_orthogonal }; pinned_pawns) [[unlikely]]
+    {
+        single_pushes |= (is_black_to_play ? get_black_pawn_single_push_squares_from_bitboard(pinned_pawns, ~all_pieces) : get_white_pawn_single_push_squares_from_bitboard(pinned_pawns, ~all_pieces)) & masks.targets & masks.pins_orthogonal;
+        double_pushes |= (is_black_to_play ? get_black_pawn_double_push_squares_from_bitboard(pinned_pawns, ~all_pieces) : get_white_pawn_double_push_squares_from_bitboard(pinned_pawns, ~all_pieces)) & masks.targets & masks.pins_orthogonal;
+    }
+
+    ret += add_pawn_moves(move_buf.subspan(ret), west_attacks & ~last_rank,  pawn_west_offset<Black>,   to_move_idx, move::type::CAPTURE);
+    ret += add_pawn_moves(move_buf.subspan(ret), east_attacks & ~last_rank,  pawn_east_offset<Black>,   to_move_idx, move::type::CAPTURE);
+    ret += add_pawn_moves(move_buf.subspan(ret), single_pushes & ~last_rank, pawn_push_offset<Black>,   to_move_idx, move::type::PAWN_PUSH_SINGLE);
+    ret += add_pawn_moves(move_buf.subspan(ret), double_pushes,              2*pawn_push_offset<Black>, to_move_idx, move::type::PAWN_PUSH_DOUBLE);
+
+    if ((west_attacks | east_attacks | single_pushes) & last_rank) [[unlikely]]
+    {
+        ret += add_pawn_promotions(move_buf.subspan(ret), west_attacks & last_rank,  pawn_west_offset<Black>, to_move_idx, move::type::CAPTURE,          move_generation::all, is_black_to_play);
+        ret += add_pawn_promotions(move_buf.subspan(ret), east_attacks & last_rank,  pawn_east_offset<Black>, to_move_idx, move::type::CAPTURE,          move_generation::all, is_black_to_play);
+        ret += add_pawn_promotions(move_buf.subspan(ret), single_pushes & last_rank, pawn_push_offset<Black>, to_move_idx, move::type::PAWN_PUSH_SINGLE, move_generation::all, is_black_to_play);
+    }
+
+    // En-passent captures take two pieces off the captured pawn's rank, which can expose our king in ways the pin masks don't
+    // catch, so (as they're rare) we just check for slider attacks on our king after each capture, which also covers pinned
+    // pawns. The only other way of being in check is from a knight, or the pawn that just double-pushed (which we're taking).
+    if (bb.en_passent_bb) [[unlikely]]
+    {
+        const std::size_t en_passent_mb { static_cast<std::size_t>(std::countr_zero(bb.en_passent_bb)) };
+        const std::uint64_t capture_bb { is_black_to_play ? (bb.en_passent_bb << 8) : (bb.en_passent_bb >> 8) };
+        const std::size_t king_mb { static_cast<std::size_t>(std::countr_zero(bb.boards[set_piece_colour(piece_idx::w_king, is_black_to_play)])) };
+        const std::uint64_t opponent_queens { bb.boards[set_piece_colour(piece_idx::w_queen, !is_black_to_play)] };
+
+        // Our pawns that attack the en-passent square are the ones an opponent pawn on it would attack.
+        for (std::uint64_t capturers { pawns & (is_black_to_play ? get_white_pawn_all_attacked_squares_from_mailbox(en_passent_mb) : get_black_pawn_all_attacked_squares_from_mailbox(en_passent_mb)) }; capturers; capturers &= capturers-1)
+        {
+            const std::size_t pawn_mailbox = std::countr_zero(capturers);
+            const std::uint64_t pieces_after_bb { all_pieces ^ (1ULL << pawn_mailbox) ^ bb.en_passent_bb ^ capture_bb };
+
+            const bool is_legal {
+                !(masks.checkers & ~capture_bb & (bb.boards[set_piece_colour(piece_idx::w_knight, !is_black_to_play)] | bb.boards[set_piece_colour(piece_idx::w_pawn, !is_black_to_play)]))
+             && !(get_rook_attacked_squares_from_mailbox(pieces_after_bb, king_mb)   & (bb.boards[set_piece_colour(piece_idx::w_rook,   !is_black_to_play)] | opponent_queens))
+             && !(get_bishop_attacked_squares_from_mailbox(pieces_after_bb, king_mb) & (bb.boards[set_piece_colour(piece_idx::w_bishop, !is_black_to_play)] | opponent_queens))
+            };
+
+            if (is_legal)
+                move_buf[ret++] = move::make_encode(pawn_mailbox, en_passent_mb, to_move_idx) | move::type::CAPTURE | move::type::EN_PASSENT;
+        }
+    }
+
+    return ret;
+}
+
+template <bool Black, typename T>
+inline std::size_t get_legal_king_moves(const bitboard& bb, std::span<T> move_buf, const legal_move_masks& masks) noexcept
 {
     std::size_t ret {};
 
-    ret += details::get_pawn_moves(bb,   move_buf.subspan(ret), true);
-    ret += details::get_king_moves(bb,   move_buf.subspan(ret), true);
-    ret += details::get_knight_moves(bb, move_buf.subspan(ret), true);
-    ret += details::get_bishop_moves(bb, move_buf.subspan(ret), true);
-    ret += details::get_rook_moves(bb,   move_buf.subspan(ret), true);
-    ret += details::get_queen_moves(bb,  move_buf.subspan(ret), true);
+    constexpr bool is_black_to_play { Black };
+    const piece_idx to_move_idx { is_black_to_play ? piece_idx::b_king : piece_idx::w_king };
+    const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
+    const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
+    const std::uint64_t all_pieces { to_move_pieces | opponent_pieces };
+
+    const std::size_t king_mailbox = std::countr_zero(bb.boards[to_move_idx]);
+
+    // Castling needs the squares between the king and rook to be empty, and the king can't be in, pass through, or end up in
+    // check.
+    if (!masks.checkers)
+    {
+        const std::uint64_t rank { is_black_to_play ? RANK_8 : RANK_1 };
+        if ((bb.castling & (is_black_to_play ? bitboard::CASTLING_B_KS : bitboard::CASTLING_W_KS)) && !(all_pieces & rank & (FILE_F | FILE_G)) && !(masks.king_danger & rank & (FILE_F | FILE_G)))
+            move_buf[ret++] = move::make_encode(king_mailbox, std::countr_zero(rank & FILE_G), to_move_idx) | move::type::CASTLE_KS;
+        if ((bb.castling & (is_black_to_play ? bitboard::CASTLING_B_QS : bitboard::CASTLING_W_QS)) && !(all_pieces & rank & (FILE_B | FILE_C | FILE_D)) && !(masks.king_danger & rank & (FILE_C | FILE_D)))
+            move_buf[ret++] = move::make_encode(king_mailbox, std::countr_zero(rank & FILE_C), to_move_idx) | move::type::CASTLE_QS;
+    }
+
+    ret += add_legal_moves(move_buf.subspan(ret), king_mailbox, to_move_idx, get_king_attacked_squares_from_mailbox(king_mailbox) & ~to_move_pieces & ~masks.king_danger, opponent_pieces);
+
+    return ret;
+}
+
+// Knights, bishops, rooks and queens. A pinned knight can never move, and a slider can only move in the direction it's
+// pinned in (if at all), so we generate the diagonal and orthogonal moves of queens separately.
+template <bool Black, typename T>
+inline std::size_t get_legal_piece_moves(const bitboard& bb, std::span<T> move_buf, const legal_move_masks& masks) noexcept
+{
+    std::size_t ret {};
+
+    constexpr bool is_black_to_play { Black };
+    const std::uint64_t to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
+    const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
+    const std::uint64_t all_pieces { to_move_pieces | opponent_pieces };
+    const std::uint64_t pinned { masks.pins_orthogonal | masks.pins_diagonal };
+
+    const piece_idx knight_idx { set_piece_colour(piece_idx::w_knight, is_black_to_play) };
+    for (std::uint64_t knights { bb.boards[knight_idx] & ~pinned }; knights; knights &= knights-1)
+    {
+        const std::size_t knight_mailbox = std::countr_zero(knights);
+        ret += add_legal_moves(move_buf.subspan(ret), knight_mailbox, knight_idx, get_knight_attacked_squares_from_mailbox(knight_mailbox) & masks.targets, opponent_pieces);
+    }
+
+    const std::uint64_t queens_bb { bb.boards[set_piece_colour(piece_idx::w_queen, is_black_to_play)] };
+    for (std::uint64_t sliders { (bb.boards[set_piece_colour(piece_idx::w_bishop, is_black_to_play)] | queens_bb) & ~masks.pins_orthogonal }; sliders; sliders &= sliders-1)
+    {
+        const std::size_t slider_mailbox = std::countr_zero(sliders);
+        std::uint64_t targets { get_bishop_attacked_squares_from_mailbox(all_pieces, slider_mailbox) & masks.targets };
+        if ((1ULL << slider_mailbox) & masks.pins_diagonal)
+            targets &= masks.pins_diagonal;
+        ret += add_legal_moves(move_buf.subspan(ret), slider_mailbox, bb.get_piece_type_mb(slider_mailbox), targets, opponent_pieces);
+    }
+    for (std::uint64_t sliders { (bb.boards[set_piece_colour(piece_idx::w_rook, is_black_to_play)] | queens_bb) & ~masks.pins_diagonal }; sliders; sliders &= sliders-1)
+    {
+        const std::size_t slider_mailbox = std::countr_zero(sliders);
+        std::uint64_t targets { get_rook_attacked_squares_from_mailbox(all_pieces, slider_mailbox) & masks.targets };
+        if ((1ULL << slider_mailbox) & masks.pins_orthogonal)
+            targets &= masks.pins_orthogonal;
+        ret += add_legal_moves(move_buf.subspan(ret), slider_mailbox, bb.get_piece_type_mb(slider_mailbox), targets, opponent_pieces);
+    }
 
     return ret;
-}
\ No newline at end of file
+}
+
+}
+
+template <bool Black, typename T>
+inline std::size_t generate_legal_moves(const bitboard& bb, std::span<T> move_buf) noexcept
+{
+    const details::legal_move_masks masks { details::get_legal_move_masks<Black>(bb) };
+
+    std::size_t ret { details::get_legal_king_moves<Black>(bb, move_buf, masks) };
+
+    // Only the king can get out of double-check.
+    if (std::popcount(masks.checkers) > 1) [[unlikely]]
+        return ret;
+
+    ret += details::get_legal_pawn_moves<Black>(bb,  move_buf.subspan(ret), masks);
+    ret += details::get_legal_piece_moves<Black>(bb, move_buf.subspan(ret), masks);
+
+    return ret;
+}
+
+template <typename T>
+inline std::size_t generate_legal_moves(const bitboard& bb, std::span<T> move_buf) noexcept
+{
+    return bb.is_black_to_play() ? generate_legal_moves<true>(bb, move_buf) : generate_legal_moves<false>(bb, move_buf);
+}
+
+inline bool is_pseudo_legal(const bitboard& bb, std::uint32_t move) noexcept
+{
+    if (move::move_is_equal(move, move::NULL_MOVE))
+        return false;
+
+    const bool is_black_to_play { bb.is_black_to_play() };
+    const std::size_t from_mb { move::make_decode_from_mb(move) };
+    const std::size_t to_mb   { move::make_decode_to_mb(move) };
+    const piece_idx piece     { move::make_decode_piece_idx(move) };
+    const piece_idx promotion { move::make_decode_promotion(move) };
+    const std::uint32_t type  { move & 0x0ff00000 };
+
+    // The piece has to be one of ours, and actually be on the from-square.
+    if ((piece & 0x07) > piece_idx::w_queen || static_cast<bool>(piece & 0x08) != is_black_to_play)
+        return false;
+
+    const std::uint64_t from_bb { 1ULL << from_mb };
+    const std::uint64_t to_bb   { 1ULL << to_mb };
+    if (!(bb.boards[piece] & from_bb))
+        return false;
+
+    const std::uint64_t to_move_pieces  { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
+    const std::uint64_t opponent_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
+    const std::uint64_t all_pieces      { to_move_pieces | opponent_pieces };
+
+    // Pawns are the only pieces with their own move-types (and the only ones that can promote).
+    if ((piece & 0x07) == piece_idx::w_pawn)
+    {
+        std::uint32_t expected {};
+        if (to_bb & (is_black_to_play ? get_black_pawn_all_attacked_squares_from_mailbox(from_mb) : get_white_pawn_all_attacked_squares_from_mailbox(from_mb)))
+        {
+            if (to_bb & opponent_pieces)
+                expected = move::type::CAPTURE;
+            else if (to_bb & bb.en_passent_bb)
+                expected = move::type::CAPTURE | move::type::EN_PASSENT;
+            else
+                return false;
+        }
+        else if (to_bb & (is_black_to_play ? get_black_pawn_single_push_squares_from_mailbox(from_mb, ~all_pieces) : get_white_pawn_single_push_squares_from_mailbox(from_mb, ~all_pieces)))
+        {
+            expected = move::type::PAWN_PUSH_SINGLE;
+        }
+        else if (to_bb & (is_black_to_play ? get_black_pawn_double_push_squares_from_mailbox(from_mb, ~all_pieces) : get_white_pawn_double_push_squares_from_mailbox(from_mb, ~all_pieces)))
+        {
+            expected = move::type::PAWN_PUSH_DOUBLE;
+        }
+        else
+        {
+            return false;
+        }
+
+        // Moves to the last rank must promote to a piece of our colour (other than a pawn or king), and no other moves
+        // can have a promotion piece.
+        if (to_bb & (is_black_to_play ? RANK_1 : RANK_8))
+        {
+            const piece_idx promotion_type { static_cast<piece_idx>(promotion & 0x07) };
+            if (promotion_type < piece_idx::w_knight || promotion_type > piece_idx::w_queen || set_piece_colour(promotion_type, is_black_to_play) != promotion)
+                return false;
+
+            expected |= move::type::PROMOTION;
+        }
+        else if (promotion)
+        {
+            return false;
+        }
+
+        return type == expected;
+    }
+
+    if (promotion)
+        return false;
+
+    // Castling has to match exactly what get_king_moves generates - we only check the squares are empty and that we still
+    // have the rights (as with everything else, castling through check is left to make_move).
+    if (type & (move::type::CASTLE_KS | move::type::CASTLE_QS))
+    {
+        if ((piece & 0x07) != piece_idx::w_king)
+            return false;
+
+        const std::uint64_t rank { is_black_to_play ? RANK_8 : RANK_1 };
+        if (from_bb != (FILE_E & rank))
+            return false;
+
+        if (type == move::type::CASTLE_KS)
+            return to_bb == (FILE_G & rank) && (bb.castling & (is_black_to_play ? bitboard::CASTLING_B_KS : bitboard::CASTLING_W_KS)) && !(all_pieces & rank & (FILE_F | FILE_G));
+        if (type == move::type::CASTLE_QS)
+            return to_bb == (FILE_C & rank) && (bb.castling & (is_black_to_play ? bitboard::CASTLING_B_QS : bitboard::CASTLING_W_QS)) && !(all_pieces & rank & (FILE_B | FILE_C | FILE_D));
+
+        return false;
+    }
+
+    // Everything else is just a capture or quiet move to any square the piece attacks that doesn't contain one of our pieces.
+    std::uint64_t attacks {};
+    switch (piece & 0x07)
+    {
+        case piece_idx::w_king:   attacks = get_king_attacked_squares_from_mailbox(from_mb);               break;
+        case piece_idx::w_knight: attacks = get_knight_attacked_squares_from_mailbox(from_mb);             break;
+        case piece_idx::w_bishop: attacks = get_bishop_attacked_squares_from_mailbox(all_pieces, from_mb); break;
+        case piece_idx::w_rook:   attacks = get_rook_attacked_squares_from_mailbox(all_pieces, from_mb);   break;
+        case piece_idx::w_queen:  attacks = get_queen_attacked_squares_from_mailbox(all_pieces, from_mb);  break;
+        default: return false;
+    }
+
+    if (!(attacks & to_bb & ~to_move_pieces))
+        return false;
+
+    return type == ((to_bb & opponent_pieces) ? move::type::CAPTURE : 0);
+}
@@ -4,6 +4,7 @@
 // DECLARATION
 // ####################################
 
+#include "config.hpp"
 #include "evaluation/evaluate.hpp"
 #include "game_state.hpp"
 #include "pieces/pieces.hpp"
@@ -30,6 +31,15 @@ void unmake_move(bitboard& bb,   std::uint64_t make_unmake, std::uint64_t& hash)
 void unmake_move(bitboard& bb,   std::uint64_t make_unmake, std::uint64_t& hash, evaluation::piece_square_eval& eval) noexcept;
 void unmake_move(game_state& gs, std::uint64_t make_unmake) noexcept;
 
+// Variants with the side that makes (or made) the move given at compile time, for callers that already know it, e.g. perft
+// carries the side to play down the tree as a template parameter. The plain versions check the side to play once and call
+// one of these.
+template <bool Black> bool make_move(const make_move_args& args, bitboard& bb, std::uint32_t make, std::uint32_t& unmake) noexcept;
+template <bool Black> bool make_move(const make_move_args& args, bitboard& bb, std::uint32_t make, std::uint32_t& unmake, std::uint64_t& hash) noexcept;
+
+template <bool Black> void unmake_move(bitboard& bb, std::uint32_t make, std::uint32_t unmake) noexcept;
+template <bool Black> void unmake_move(bitboard& bb, std::uint32_t make, std::uint32_t unmake, std::uint64_t& hash) noexcept;
+
 // ####################################
 // IMPLEMENTATION
 // ####################################
@@ -41,19 +51,34 @@ void unmake_move(game_state& gs, std::uint64_t make_unmake) noexcept;
 namespace details
 {
 
-inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32_t make, std::uint32_t& unmake, std::uint64_t& hash, evaluation::piece_square_eval& eval) noexcept
+// The prefetch hook for when nobody is interested in the new hashes.
+struct no_prefetch
+{
+    void operator()(std::uint64_t, std::uint64_t) const noexcept {}
+};
+
+// The pawn hash is the Zobrist hash of just the pawns, which only changes on pawn moves and captures.
+//
+// The prefetch hook is called with the hash and pawn hash of the new position as soon as they are known, so that the caller
+// can start pulling any hash-table entries it will probe into cache while we're still checking legality.
+//
+// The side making the move (black if Black) is a template parameter, so that none of the colour-dependent choices below are
+// made at runtime - the variant without it checks the side to play once and calls the right one.
+template <bool Black, typename Prefetch = no_prefetch>
+inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32_t make, std::uint32_t& unmake, std::uint64_t& hash, std::uint64_t& pawn_hash, evaluation::piece_square_eval& eval, Prefetch prefetch = {}) noexcept
 {
     bool ret { true };
 
     unmake = 0;
 
-    const bool is_black_to_play   { bb.is_black_to_play() };
-    std::uint64_t& to_move_pieces { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
+    constexpr bool is_black_to_play { Black };
+    std::uint64_t& to_move_pieces   { is_black_to_play ? bb.boards[piece_idx::b_any] : bb.boards[piece_idx::w_any] };
 
     // The move only contains the piece up to colour - exactly which colour piece must be derived from the side-to-play.
     const std::size_t from_mb { move::make_decode_from_mb(make) };
     const std::size_t to_mb   { move::make_decode_to_mb(make) };
     const piece_idx piece     { move::make_decode_piece_idx(make) };
+    const bool is_pawn        { (piece & 0x07) == piece_idx::w_pawn };
 
     // All of the above information is overwritten if this is a null-move (the value 0).
     const bool is_null { make == move::NULL_MOVE };
@@ -103,12 +128,19 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
         hash        ^= zobrist::get_code_castling(bb.castling);
     }
 
+    // The piece on the target square (i.e. the captured piece for anything but en-passent) has to be looked up before we
+    // move our piece on top of it.
+    const piece_idx to_piece { bb.squares[to_mb] };
+
     // Next we handle mechanically moving the side-to-plays piece. We have to be careful about the special case of
     // pawn promotions when updating the piece-specific bitboard.
     if (!is_null) [[likely]]
     {
         to_move_pieces ^= from_to_bb;
         hash           ^= zobrist::get_code_piece(piece, from_mb);
+        if (is_pawn)
+            pawn_hash  ^= zobrist::get_code_piece(piece, from_mb);
+        bb.squares[from_mb] = piece_idx::empty;
 
         eval.mg -= (evaluation::piece_mg_evaluation[piece] + evaluation::piece_square_mg_evaluation[piece][from_mb]);
         eval.eg -= (evaluation::piece_eg_evaluation[piece] + evaluation::piece_square_eg_evaluation[piece][from_mb]);
@@ -119,6 +151,7 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
 
             bb.boards[piece]         ^= from_bb;
             bb.boards[promotion_idx] ^= to_bb;
+            bb.squares[to_mb]         = promotion_idx;
             hash                     ^= zobrist::get_code_piece(promotion_idx, to_mb);
 
             // Note that pawns don't affect the game-phase.
@@ -129,7 +162,10 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
         else
         {
             bb.boards[piece] ^= from_to_bb;
+            bb.squares[to_mb] = piece;
             hash             ^= zobrist::get_code_piece(piece, to_mb);
+            if (is_pawn)
+                pawn_hash    ^= zobrist::get_code_piece(piece, to_mb);
 
             eval.mg += evaluation::piece_mg_evaluation[piece] + evaluation::piece_square_mg_evaluation[piece][to_mb];
             eval.eg += evaluation::piece_eg_evaluation[piece] + evaluation::piece_square_eg_evaluation[piece][to_mb];
@@ -150,23 +186,27 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
 
             opponent_pieces        ^= capture_bb;
             bb.boards[capture_idx] ^= capture_bb;
+            bb.squares[capture_mb]  = piece_idx::empty;
             hash                   ^= zobrist::get_code_piece(capture_idx, capture_mb);
+            pawn_hash              ^= zobrist::get_code_piece(capture_idx, capture_mb);
 
             // Note that pawns don't affect the game-phase.
             eval.mg -= (evaluation::piece_mg_evaluation[capture_idx] + evaluation::piece_square_mg_evaluation[capture_idx][capture_mb]);
             eval.eg -= (evaluation::piece_eg_evaluation[capture_idx] + evaluation::piece_square_eg_evaluation[capture_idx][capture_mb]);
         }
-        // For regular piece captures, we have to loop through the opponents piece bitboards to find the one containing
-        // the piece to remove. We also have to remember to fill in the unmake-move so we can recover the piece when
-        // going in reverse.
+        // For regular piece captures, the piece to remove is the one we looked up on the target square (which our own piece
+        // has already overwritten in the mailbox). We also have to remember to fill in the unmake-move so we can recover the
+        // piece when going in reverse.
         else
         {
-            const auto capture_idx = bb.get_piece_type_colour(to_bb, !is_black_to_play, true);
-            unmake |= move::unmake_encode_capture(static_cast<piece_idx>(capture_idx));
+            const piece_idx capture_idx { to_piece };
+            unmake |= move::unmake_encode_capture(capture_idx);
 
             opponent_pieces        ^= to_bb;
             bb.boards[capture_idx] ^= to_bb;
-            hash                   ^= zobrist::get_code_piece(static_cast<piece_idx>(capture_idx), to_mb);
+            hash                   ^= zobrist::get_code_piece(capture_idx, to_mb);
+            if ((capture_idx & 0x07) == piece_idx::w_pawn)
+                pawn_hash          ^= zobrist::get_code_piece(capture_idx, to_mb);
 
             eval.mg -= (evaluation::piece_mg_evaluation[capture_idx] + evaluation::piece_square_mg_evaluation[capture_idx][to_mb]);
             eval.eg -= (evaluation::piece_eg_evaluation[capture_idx] + evaluation::piece_square_eg_evaluation[capture_idx][to_mb]);
@@ -197,7 +237,7 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
     // Handle moving the rook for castling (legality is checked below).
     if (make & move::type::CASTLE_KS) [[unlikely]]
     {
-        if (is_black_to_play)
+        if constexpr (is_black_to_play)
         {
             constexpr std::size_t from_mb      { std::countr_zero(FILE_H & RANK_8) };
             constexpr std::size_t to_mb        { std::countr_zero(FILE_F & RANK_8) };
@@ -205,6 +245,8 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
 
             bb.boards[piece_idx::b_rook] ^= from_to_bb;
             bb.boards[piece_idx::b_any]  ^= from_to_bb;
+            bb.squares[from_mb]          = piece_idx::empty;
+            bb.squares[to_mb]            = piece_idx::b_rook;
 
             constexpr std::uint64_t code {
                 zobrist::get_code_piece(piece_idx::b_rook, from_mb)
@@ -223,6 +265,8 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
 
             bb.boards[piece_idx::w_rook] ^= from_to_bb;
             bb.boards[piece_idx::w_any]  ^= from_to_bb;
+            bb.squares[from_mb]          = piece_idx::empty;
+            bb.squares[to_mb]            = piece_idx::w_rook;
 
             constexpr std::uint64_t code {
                 zobrist::get_code_piece(piece_idx::w_rook, from_mb)
@@ -236,7 +280,7 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
     }
     else if (make & move::type::CASTLE_QS) [[unlikely]]
     {
-        if (is_black_to_play)
+        if constexpr (is_black_to_play)
         {
             constexpr std::size_t from_mb      { std::countr_zero(FILE_A & RANK_8) };
             constexpr std::size_t to_mb        { std::countr_zero(FILE_D & RANK_8) };
@@ -244,6 +288,8 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
 
             bb.boards[piece_idx::b_rook] ^= from_to_bb;
             bb.boards[piece_idx::b_any]  ^= from_to_bb;
+            bb.squares[from_mb]          = piece_idx::empty;
+            bb.squares[to_mb]            = piece_idx::b_rook;
 
             constexpr std::uint64_t code {
                 zobrist::get_code_piece(piece_idx::b_rook, from_mb)
@@ -262,6 +308,8 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
 
             bb.boards[piece_idx::w_rook] ^= from_to_bb;
             bb.boards[piece_idx::w_any]  ^= from_to_bb;
+            bb.squares[from_mb]          = piece_idx::empty;
+            bb.squares[to_mb]            = piece_idx::w_rook;
 
             constexpr std::uint64_t code {
                 zobrist::get_code_piece(piece_idx::w_rook, from_mb)
@@ -274,41 +322,54 @@ inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32
         }
     }
 
+    // The hashes are now final.
+    prefetch(hash, pawn_hash);
+
     // Handle left-in-check legality checking.
     if (args.check_legality)
     {
         if (make & move::type::CASTLE_KS) [[unlikely]]
         {
-            if (is_black_to_play)
+            if constexpr (is_black_to_play)
                 ret = !get_attackers_white(bb, std::countr_zero(FILE_E & RANK_8), std::countr_zero(FILE_F & RANK_8), std::countr_zero(FILE_G & RANK_8));
             else
                 ret = !get_attackers_black(bb, std::countr_zero(FILE_E & RANK_1), std::countr_zero(FILE_F & RANK_1), std::countr_zero(FILE_G & RANK_1));
         }
         else if (make & move::type::CASTLE_QS) [[unlikely]]
         {
-            if (is_black_to_play)
+            if constexpr (is_black_to_play)
                 ret = !get_attackers_white(bb, std::countr_zero(FILE_E & RANK_8), std::countr_zero(FILE_D & RANK_8), std::countr_zero(FILE_C & RANK_8));
             else
                 ret = !get_attackers_black(bb, std::countr_zero(FILE_E & RANK_1), std::countr_zero(FILE_D & RANK_1), std::countr_zero(FILE_C & RANK_1));
         }
         else
         {
-            ret = !is_in_check(bb, is_black_to_play);
+            ret = !is_in_check<is_black_to_play>(bb);
         }
     }
 
     return ret;
 }
 
-inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unmake, std::uint64_t& hash, evaluation::piece_square_eval& eval) noexcept
+template <typename Prefetch = no_prefetch>
+inline bool make_move_impl(const make_move_args& args, bitboard& bb, std::uint32_t make, std::uint32_t& unmake, std::uint64_t& hash, std::uint64_t& pawn_hash, evaluation::piece_square_eval& eval, Prefetch prefetch = {}) noexcept
+{
+    return bb.is_black_to_play() ? make_move_impl<true>(args, bb, make, unmake, hash, pawn_hash, eval, prefetch)
+                                 : make_move_impl<false>(args, bb, make, unmake, hash, pawn_hash, eval, prefetch);
+}
+
+// As with make_move_impl, the side that made the move being unmade (i.e. not the side now to play) is a template parameter.
+template <bool Black>
+inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unmake, std::uint64_t& hash, std::uint64_t& pawn_hash, evaluation::piece_square_eval& eval) noexcept
 {
-    const bool is_black_to_play   { bb.is_black_to_play() };
-    std::uint64_t& to_move_pieces { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
+    constexpr bool is_black_to_play { !Black };
+    std::uint64_t& to_move_pieces   { is_black_to_play ? bb.boards[piece_idx::w_any] : bb.boards[piece_idx::b_any] };
 
     // The move only contains the piece up to colour - exactly which colour piece must be derived from the side-to-play.
     const std::size_t from_mb   { move::make_decode_from_mb(make) };
     const std::size_t to_mb     { move::make_decode_to_mb(make) };
     const piece_idx piece       { move::make_decode_piece_idx(make) };
+    const bool is_pawn          { (piece & 0x07) == piece_idx::w_pawn };
 
     // All of the above information is overwritten if this is a null-move (the LSBs are 0 - the MSBs will contain unmake information like normal).
     const bool is_null { make == move::NULL_MOVE };
@@ -343,6 +404,10 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
     {
         to_move_pieces ^= from_to_bb;
         hash           ^= zobrist::get_code_piece(piece, from_mb);
+        if (is_pawn)
+            pawn_hash  ^= zobrist::get_code_piece(piece, from_mb);
+        bb.squares[from_mb] = piece;
+        bb.squares[to_mb]   = piece_idx::empty;
 
         eval.mg += evaluation::piece_mg_evaluation[piece] + evaluation::piece_square_mg_evaluation[piece][from_mb];
         eval.eg += evaluation::piece_eg_evaluation[piece] + evaluation::piece_square_eg_evaluation[piece][from_mb];
@@ -363,6 +428,8 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
         else
         {
             hash ^= zobrist::get_code_piece(piece, to_mb);
+            if (is_pawn)
+                pawn_hash ^= zobrist::get_code_piece(piece, to_mb);
             bb.boards[piece] ^= from_to_bb;
 
             eval.mg -= (evaluation::piece_mg_evaluation[piece] + evaluation::piece_square_mg_evaluation[piece][to_mb]);
@@ -384,7 +451,9 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
 
             opponent_pieces        ^= capture_bb;
             bb.boards[capture_idx] ^= capture_bb;
+            bb.squares[capture_mb]  = capture_idx;
             hash                   ^= zobrist::get_code_piece(capture_idx, capture_mb);
+            pawn_hash              ^= zobrist::get_code_piece(capture_idx, capture_mb);
 
             // Note that pawns don't affect the game-phase.
             eval.mg += evaluation::piece_mg_evaluation[capture_idx] + evaluation::piece_square_mg_evaluation[capture_idx][capture_mb];;
@@ -397,7 +466,10 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
 
             opponent_pieces        ^= to_bb;
             bb.boards[capture_idx] ^= to_bb;
+            bb.squares[to_mb]       = capture_idx;
             hash                   ^= zobrist::get_code_piece(capture_idx, capture_mb);
+            if ((capture_idx & 0x07) == piece_idx::w_pawn)
+                pawn_hash          ^= zobrist::get_code_piece(capture_idx, capture_mb);
 
             eval.mg += evaluation::piece_mg_evaluation[capture_idx] + evaluation::piece_square_mg_evaluation[capture_idx][to_mb];
             eval.eg += evaluation::piece_eg_evaluation[capture_idx] + evaluation::piece_square_eg_evaluation[capture_idx][to_mb];
@@ -408,7 +480,7 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
     // Handle moving the rook for castling.
     if (make & move::type::CASTLE_KS) [[unlikely]]
     {
-        if (!is_black_to_play)
+        if constexpr (!is_black_to_play)
         {
             constexpr std::size_t from_mb      { std::countr_zero(FILE_H & RANK_8) };
             constexpr std::size_t to_mb        { std::countr_zero(FILE_F & RANK_8) };
@@ -416,6 +488,8 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
 
             bb.boards[piece_idx::b_rook] ^= from_to_bb;
             bb.boards[piece_idx::b_any]  ^= from_to_bb;
+            bb.squares[from_mb]          = piece_idx::b_rook;
+            bb.squares[to_mb]            = piece_idx::empty;
 
             constexpr std::uint64_t code {
                 zobrist::get_code_piece(piece_idx::b_rook, from_mb)
@@ -434,6 +508,8 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
 
             bb.boards[piece_idx::w_rook] ^= from_to_bb;
             bb.boards[piece_idx::w_any]  ^= from_to_bb;
+            bb.squares[from_mb]          = piece_idx::w_rook;
+            bb.squares[to_mb]            = piece_idx::empty;
 
             constexpr std::uint64_t code {
                 zobrist::get_code_piece(piece_idx::w_rook, from_mb)
@@ -447,7 +523,7 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
     }
     else if (make & move::type::CASTLE_QS) [[unlikely]]
     {
-        if (!is_black_to_play)
+        if constexpr (!is_black_to_play)
         {
             constexpr std::size_t from_mb      { std::countr_zero(FILE_A & RANK_8) };
             constexpr std::size_t to_mb        { std::countr_zero(FILE_D & RANK_8) };
@@ -455,6 +531,8 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
 
             bb.boards[piece_idx::b_rook] ^= from_to_bb;
             bb.boards[piece_idx::b_any]  ^= from_to_bb;
+            bb.squares[from_mb]          = piece_idx::b_rook;
+            bb.squares[to_mb]            = piece_idx::empty;
 
             constexpr std::uint64_t code {
                 zobrist::get_code_piece(piece_idx::b_rook, from_mb)
@@ -473,6 +551,8 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
 
             bb.boards[piece_idx::w_rook] ^= from_to_bb;
             bb.boards[piece_idx::w_any]  ^= from_to_bb;
+            bb.squares[from_mb]          = piece_idx::w_rook;
+            bb.squares[to_mb]            = piece_idx::empty;
 
             constexpr std::uint64_t code {
                 zobrist::get_code_piece(piece_idx::w_rook, from_mb)
@@ -486,6 +566,14 @@ inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unm
     }
 }
 
+inline void unmake_move_impl(bitboard& bb, std::uint32_t make, std::uint32_t unmake, std::uint64_t& hash, std::uint64_t& pawn_hash, evaluation::piece_square_eval& eval) noexcept
+{
+    if (bb.is_black_to_play())
+        unmake_move_impl<false>(bb, make, unmake, hash, pawn_hash, eval);
+    else
+        unmake_move_impl<true>(bb, make, unmake, hash, pawn_hash, eval);
+}
+
 }
 
 inline bool make_move(const make_move_args& args, bitboard& bb, std::uint32_t make) noexcept
@@ -505,13 +593,15 @@ inline bool make_move(const make_move_args& args, bitboard& bb, std::uint32_t ma
 inline bool make_move(const make_move_args& args, bitboard& bb, std::uint32_t make, std::uint32_t& unmake, std::uint64_t& hash) noexcept
 {
     // Dummy (will hopefully get optimised away).
-    evaluation::piece_square_eval eval_dummy;
+    evaluation::piece_square_eval eval_dummy {};
     return make_move(args, bb, make, unmake, hash, eval_dummy);
 }
 
 inline bool make_move(const make_move_args& args, bitboard& bb,   std::uint32_t make, std::uint32_t& unmake, std::uint64_t& hash, evaluation::piece_square_eval& eval) noexcept
 {
-    const bool ret { details::make_move_impl(args, bb, make, unmake, hash, eval) };
+    // Dummy (will hopefully get optimised away).
+    std::uint64_t pawn_hash_dummy {};
+    const bool ret { details::make_move_impl(args, bb, make, unmake, hash, pawn_hash_dummy, eval) };
 
     // Increment the ply-counter.
     bb.ply_counter++;
@@ -528,7 +618,21 @@ inline bool make_move(const make_move_args& args, game_state& gs, std::uint32_t
 
 inline bool make_move(const make_move_args& args, game_state& gs, std::uint32_t make, std::uint32_t& unmake) noexcept
 {
-    const bool ret { details::make_move_impl(args, gs.bb, make, unmake, gs.hash, gs.piece_square_eval) };
+    // The search probes the transposition table as soon as it enters the new node (and the evaluation cache and pawn hash
+    // table when it evaluates it), which is otherwise almost always a cache-miss.
+    const auto prefetch = [&gs] (std::uint64_t hash, std::uint64_t pawn_hash) noexcept
+    {
+        if constexpr (config::tt_prefetch)
+            gs.tt->prefetch(hash);
+        if constexpr (config::eval_cache)
+            gs.eval_cache->prefetch(hash);
+        if constexpr (config::eval_ps && config::pawn_hash)
+            gs.pawn_hash_table->prefetch(pawn_hash);
+    };
+
+    const bool ret { details::make_move_impl(args, gs.bb, make, unmake, gs.hash, gs.pawn_hash, gs.piece_square_eval, prefetch) };
+    if (gs.nnue && make != move::NULL_MOVE)
+        evaluation::nnue::make_move(gs.nnue_accumulator, *gs.nnue, make, unmake, gs.bb.is_black_to_play());
 
     // Add our move to our game-state history and increment the ply-counter.
     gs.position_history[++gs.bb.ply_counter] = gs.hash;
@@ -546,13 +650,15 @@ inline void unmake_move(bitboard& bb, std::uint32_t make, std::uint32_t unmake)
 inline void unmake_move(bitboard& bb, std::uint32_t make, std::uint32_t unmake, std::uint64_t& hash) noexcept
 {
     // Dummy (will hopefully get optimised away).
-    evaluation::piece_square_eval eval_dummy;
+    evaluation::piece_square_eval eval_dummy {};
     unmake_move(bb, make, unmake, hash, eval_dummy);
 }
 
 inline void unmake_move(bitboard& bb, std::uint32_t make, std::uint32_t unmake, std::uint64_t& hash, evaluation::piece_square_eval& eval) noexcept
 {
-    details::unmake_move_impl(bb, make, unmake, hash, eval);
+    // Dummy (will hopefully get optimised away).
+    std::uint64_t pawn_hash_dummy {};
+    details::unmake_move_impl(bb, make, unmake, hash, pawn_hash_dummy, eval);
 
     // Decrement the ply-counter.
     bb.ply_counter--;
@@ -560,10 +666,13 @@ inline void unmake_move(bitboard& bb, std::uint32_t make, std::uint32_t unmake,
 
 inline void unmake_move(game_state& gs, std::uint32_t make, std::uint32_t unmake) noexcept
 {
-    details::unmake_move_impl(gs.bb, make, unmake, gs.hash, gs.piece_square_eval);
+    details::unmake_move_impl(gs.bb, make, unmake, gs.hash, gs.pawn_hash, gs.piece_square_eval);
 
     // Decrement the ply-counter.
     gs.bb.ply_counter--;
+
+    if (gs.nnue && make != move::NULL_MOVE)
+        evaluation::nnue::unmake_move(gs.nnue_accumulator, *gs.nnue, make, unmake, gs.bb.is_black_to_play());
 }
 
 inline void unmake_move(bitboard& bb, std::uint64_t make_unmake) noexcept
@@ -595,8 +704,53 @@ inline void unmake_move(game_state& gs, std::uint64_t make_unmake) noexcept
     const std::uint32_t make   = make_unmake;
     const std::uint32_t unmake = make_unmake >> 32;
 
-    details::unmake_move_impl(gs.bb, make, unmake, gs.hash, gs.piece_square_eval);
+    details::unmake_move_impl(gs.bb, make, unmake, gs.hash, gs.pawn_hash, gs.piece_square_eval);
 
     // Decrement the ply-counter.
     gs.bb.ply_counter--;
+
+    if (gs.nnue && make != move::NULL_MOVE)
+        evaluation::nnue::unmake_move(gs.nnue_accumulator, *gs.nnue, make, unmake, gs.bb.is_black_to_play());
+}
+
+template <bool Black>
+inline bool make_move(const make_move_args& args, bitboard& bb, std::uint32_t make, std::uint32_t& unmake) noexcept
+{
+    // Dummy hash (will hopefully get optimised away).
+    std::uint64_t hash_dummy {};
+    return make_move<Black>(args, bb, make, unmake, hash_dummy);
+}
+
+template <bool Black>
+inline bool make_move(const make_move_args& args, bitboard& bb, std::uint32_t make, std::uint32_t& unmake, std::uint64_t& hash) noexcept
+{
+    // Dummies (will hopefully get optimised away).
+    std::uint64_t pawn_hash_dummy {};
+    evaluation::piece_square_eval eval_dummy {};
+    const bool ret { details::make_move_impl<Black>(args, bb, make, unmake, hash, pawn_hash_dummy, eval_dummy) };
+
+    // Increment the ply-counter.
+    bb.ply_counter++;
+
+    return ret;
+}
+
+template <bool Black>
+inline void unmake_move(bitboard& bb, std::uint32_t make, std::uint32_t unmake) noexcept
+{
+    // Dummy hash (will hopefully get optimised away).
+    std::uint64_t hash_dummy {};
+    unmake_move<Black>(bb, make, unmake, hash_dummy);
+}
+
+template <bool Black>
+inline void unmake_move(bitboard& bb, std::uint32_t make, std::uint32_t unmake, std::uint64_t& hash) noexcept
+{
+    // Dummies (will hopefully get optimised away).
+    std::uint64_t pawn_hash_dummy {};
+    evaluation::piece_square_eval eval_dummy {};
+    details::unmake_move_impl<Black>(bb, make, unmake, hash, pawn_hash_dummy, eval_dummy);
+
+    // Decrement the ply-counter.
+    bb.ply_counter--;
 }
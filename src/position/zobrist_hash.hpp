@@ -47,4 +47,17 @@ constexpr std::uint64_t hash_init(const mailbox& mb) noexcept
     return ret;
 }
 
+// The hash of just the pawns, which the pawn-structure evaluation is cached against. Again, this should only be called when
+// initialising from a given position.
+constexpr std::uint64_t pawn_hash_init(const mailbox& mb) noexcept
+{
+    std::uint64_t ret {};
+
+    for (std::size_t i = 0; i < mb.squares.size(); i++)
+        if (mb.squares[i] == piece_idx::w_pawn || mb.squares[i] == piece_idx::b_pawn)
+            ret ^= get_code_piece(mb.squares[i], i);
+
+    return ret;
+}
+
 }
\ No newline at end of file
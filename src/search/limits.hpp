@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace search
+{
+
+// What a search is limited to, other than its time. A node-limited search stops once the main thread has searched the given
+// number of nodes (over all of its iterations), so on a single thread it's reproducible on any hardware. A mate search never
+// goes deeper than it takes to find a mate in the given number of moves (and like any search, stops once it finds one).
+struct limits
+{
+    std::size_t depth { 64 };
+    std::size_t nodes { std::numeric_limits<std::size_t>::max() };
+    std::size_t mate  {};
+
+    // The moves to choose between at the root, or empty for all of them.
+    std::vector<std::uint32_t> root_moves {};
+};
+
+}
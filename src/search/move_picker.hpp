@@ -0,0 +1,361 @@
+#pragma once
+
+// ####################################
+// DECLARATION
+// ####################################
+
+#include "evaluation/evaluate.hpp"
+#include "evaluation/see.hpp"
+#include "pieces/pieces.hpp"
+#include "position/attacks.hpp"
+#include "position/game_state.hpp"
+#include "position/generate_moves.hpp"
+#include "position/move.hpp"
+
+#include "config.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+
+namespace search
+{
+
+// Hands out the moves of a position one at a time, roughly best first. Moves are generated and scored a stage at a time, and
+// each stage is only picked through (selection-sort style) as far as we actually get - most cut-nodes cut on the hash move or
+// a capture, in which case we never even generate the quiet moves. The main search goes through the stages:
+//
+//     hash move -> PV move -> winning captures (by SEE) -> killers -> quiet moves (by history) -> losing captures
+//
+// while quiescence search only goes through the loud moves, promotions first and then captures by MVV/LVA. In the main search
+// the moves that give check are tagged as such, which is worked out up-front without having to make the moves.
+class move_picker
+{
+public:
+    // For the main search. The hash move must either be pseudo-legal or the null-move.
+    move_picker(const game_state& gs, std::span<std::int64_t> move_buf, std::size_t draft, std::uint32_t hash_move, std::uint32_t pv_move) noexcept;
+
+    // For quiescence search.
+    move_picker(const game_state& gs, std::span<std::int64_t> move_buf) noexcept;
+
+    // Returns the next move (with its info bits filled in), or the null-move once we've run out of moves.
+    std::uint32_t next() noexcept;
+
+    // The part of the move buffer we haven't used (yet), which is where the child nodes can put their moves.
+    std::span<std::int64_t> get_unused_buf() const noexcept { return _move_buf.subspan(_end); }
+
+private:
+    enum class stage : std::uint8_t
+    {
+        hash,
+        pv,
+        captures_generate,
+        captures_winning,
+        killers,
+        quiets_generate,
+        quiets,
+        captures_losing,
+        quiescent_generate,
+        quiescent,
+        done
+    };
+
+    const game_state& _gs;
+    std::span<std::int64_t> _move_buf;
+    std::size_t _draft {};
+    stage _stage;
+
+    // Only filled in for the main search, as quiescence search doesn't care about checks.
+    bool _tag_checks {};
+    check_info _check_info {};
+
+    // Whether we're at the root of a search that's restricted to some of its moves.
+    bool _restrict_root {};
+
+    // The moves we play before generating anything, which we then have to skip when they come up in the generated stages.
+    std::uint32_t _hash_move {};
+    std::uint32_t _pv_move {};
+    std::array<std::uint32_t, ::details::km_table::KM_MOVES> _killer_moves {};
+    std::size_t _killer_idx {};
+
+    // The generated captures are in [0, _captures_end), and the quiet moves in [_captures_end, _end).
+    std::size_t _captures_cur {};
+    std::size_t _captures_end {};
+    std::size_t _quiets_cur {};
+    std::size_t _end {};
+
+    std::uint32_t next_untagged() noexcept;
+
+    bool is_already_played(std::uint32_t move) const noexcept;
+
+    // Swaps the highest scoring move in [cur, end) to cur, returning it.
+    std::int64_t pick_best(std::size_t cur, std::size_t end) noexcept;
+
+    void score_capture(std::int64_t& move) const noexcept;
+    void score_quiet(std::int64_t& move) const noexcept;
+    void score_quiescent(std::int64_t& move) const noexcept;
+};
+
+namespace details
+{
+
+int mvv_lva_score(const bitboard& bb, std::uint32_t move);
+
+}
+
+}
+
+// ####################################
+// IMPLEMENTATION
+// ####################################
+
+namespace search
+{
+
+namespace details
+{
+
+inline int mvv_lva_score(const bitboard& bb, std::uint32_t move)
+{
+    // Multiplying the victim score ensures it's the dominant term.
+    constexpr int victim_attacker_ratio { 10 };
+
+    // Handle the special case of en-passent capture.
+    if (move & move::type::EN_PASSENT) [[unlikely]]
+        return victim_attacker_ratio-1;
+
+    const auto attacker = move::make_decode_piece_idx(move);
+    const auto victim   = bb.get_piece_type_mb(move::make_decode_to_mb(move));
+
+    const int victim_val   { std::abs(::evaluation::piece_mg_evaluation[victim]) };
+    const int attacker_val { std::abs(::evaluation::piece_mg_evaluation[attacker]) };
+
+    // Multiplying the victim score ensures it's the dominant term.
+    return victim_attacker_ratio*victim_val - attacker_val;
+}
+
+constexpr int mvv_lva_score_min   { 10*::evaluation::piece_mg_evaluation[piece_idx::w_pawn]  - ::evaluation::piece_mg_evaluation[piece_idx::w_queen] };
+constexpr int mvv_lva_score_max   { 10*::evaluation::piece_mg_evaluation[piece_idx::w_queen] - ::evaluation::piece_mg_evaluation[piece_idx::w_pawn]  };
+constexpr int mvv_lva_score_range { mvv_lva_score_max - mvv_lva_score_min };
+
+// Move scores within each stage - promotions come before anything else in their stage, and winning captures are everything
+// scored above the losing-capture range.
+constexpr std::int32_t score_promotion       { std::numeric_limits<std::int32_t>::max()/2 };
+constexpr std::int32_t score_capture_winning { score_promotion/2 };
+
+// Captures with a SEE above this are considered winning (we allow some flexibility, e.g. for trading a bishop for a knight).
+constexpr int winning_capture_see_delta { -100 };
+
+}
+
+inline move_picker::move_picker(const game_state& gs, std::span<std::int64_t> move_buf, std::size_t draft, std::uint32_t hash_move, std::uint32_t pv_move) noexcept
+    : _gs(gs)
+    , _move_buf(move_buf)
+    , _draft(draft)
+    , _stage(stage::hash)
+    , _tag_checks(true)
+    , _check_info(get_check_info(gs.bb))
+    , _restrict_root(draft == 0 && !gs.root_moves.empty())
+    , _hash_move(hash_move & 0x0fffffff)
+    , _pv_move(pv_move & 0x0fffffff)
+{}
+
+inline move_picker::move_picker(const game_state& gs, std::span<std::int64_t> move_buf) noexcept
+    : _gs(gs)
+    , _move_buf(move_buf)
+    , _stage(stage::quiescent_generate)
+{}
+
+inline bool move_picker::is_already_played(std::uint32_t move) const noexcept
+{
+    return move::move_is_equal(move, _hash_move)
+        || move::move_is_equal(move, _pv_move)
+        || move::move_is_equal(move, _killer_moves[0])
+        || move::move_is_equal(move, _killer_moves[1]);
+}
+
+inline std::int64_t move_picker::pick_best(std::size_t cur, std::size_t end) noexcept
+{
+    std::size_t best { cur };
+    for (std::size_t i = cur+1; i < end; i++)
+        if (_move_buf[i] > _move_buf[best])
+            best = i;
+
+    std::swap(_move_buf[cur], _move_buf[best]);
+    return _move_buf[cur];
+}
+
+inline void move_picker::score_capture(std::int64_t& move) const noexcept
+{
+    std::int64_t score;
+    if (move & move::type::PROMOTION) [[unlikely]]
+    {
+        score = details::score_promotion;
+    }
+    else
+    {
+        // Captures are divided into winning and loosing buckets according to their SEE, and then ordered by MVV/LVA in each.
+        const bool winning_capture { evaluation::see_capture(_gs.bb, move) > details::winning_capture_see_delta };
+        const int mvv_lva { details::mvv_lva_score(_gs.bb, move) };
+        score = winning_capture ? details::score_capture_winning + mvv_lva - details::mvv_lva_score_min : mvv_lva;
+    }
+
+    move |= static_cast<std::int64_t>(score << 32);
+}
+
+inline void move_picker::score_quiet(std::int64_t& move) const noexcept
+{
+    std::int64_t score;
+    if (move & move::type::PROMOTION) [[unlikely]]
+        score = details::score_promotion;
+    else if (config::hh)
+        score = _gs.hh.get_bonus(move);
+    else
+        score = 0;
+
+    move |= static_cast<std::int64_t>(score << 32);
+}
+
+inline void move_picker::score_quiescent(std::int64_t& move) const noexcept
+{
+    const std::int64_t score { (move & move::type::PROMOTION) ? details::score_promotion : details::mvv_lva_score(_gs.bb, move) };
+    move |= static_cast<std::int64_t>(score << 32);
+}
+
+inline std::uint32_t move_picker::next() noexcept
+{
+    std::uint32_t move { next_untagged() };
+
+    // Skip over the moves we've been told not to search at the root.
+    while (_restrict_root && move && std::none_of(_gs.root_moves.begin(), _gs.root_moves.end(), [move] (std::uint32_t m) { return move::move_is_equal(m, move); }))
+        move = next_untagged();
+
+    if (_tag_checks && move && gives_check(_gs.bb, _check_info, move))
+        return move | move::info::CHECK;
+    return move;
+}
+
+inline std::uint32_t move_picker::next_untagged() noexcept
+{
+    switch (_stage)
+    {
+        case stage::hash:
+        {
+            _stage = stage::pv;
+            if (_hash_move)
+                return _hash_move | move::info::HASH;
+            [[fallthrough]];
+        }
+        case stage::pv:
+        {
+            // The PV move is from the previous iteration at this ply, so might not even be for this position.
+            _stage = stage::captures_generate;
+            if (_pv_move && !move::move_is_equal(_pv_move, _hash_move) && is_pseudo_legal(_gs.bb, _pv_move))
+                return _pv_move | move::info::PV;
+            _pv_move = 0;
+            [[fallthrough]];
+        }
+        case stage::captures_generate:
+        {
+            _captures_end = generate_pseudo_legal_loud_moves(_gs.bb, _move_buf);
+            _end = _captures_end;
+            for (std::size_t i = 0; i < _captures_end; i++)
+                score_capture(_move_buf[i]);
+
+            _stage = stage::captures_winning;
+            [[fallthrough]];
+        }
+        case stage::captures_winning:
+        {
+            while (_captures_cur < _captures_end)
+            {
+                const std::int64_t move { pick_best(_captures_cur, _captures_end) };
+                if ((move >> 32) < details::score_capture_winning)
+                    break;
+
+                _captures_cur++;
+                if (!is_already_played(move))
+                    return static_cast<std::uint32_t>(move);
+            }
+
+            _stage = stage::killers;
+            [[fallthrough]];
+        }
+        case stage::killers:
+        {
+            // Killers are always quiet moves, so they are only playable here if they're still pseudo-legal quiet moves.
+            while (config::km && _killer_idx < _killer_moves.size())
+            {
+                const std::uint32_t move { _gs.km.table[_draft][_killer_idx++] };
+                if (move && !is_already_played(move) && is_pseudo_legal(_gs.bb, move))
+                {
+                    _killer_moves[_killer_idx-1] = move;
+                    return move | move::info::KILLER;
+                }
+            }
+
+            _stage = stage::quiets_generate;
+            [[fallthrough]];
+        }
+        case stage::quiets_generate:
+        {
+            _quiets_cur = _captures_end;
+            _end = _captures_end + generate_pseudo_legal_quiet_moves(_gs.bb, _move_buf.subspan(_captures_end));
+            for (std::size_t i = _captures_end; i < _end; i++)
+                score_quiet(_move_buf[i]);
+
+            _stage = stage::quiets;
+            [[fallthrough]];
+        }
+        case stage::quiets:
+        {
+            while (_quiets_cur < _end)
+            {
+                const std::int64_t move { pick_best(_quiets_cur++, _end) };
+                if (!is_already_played(move))
+                    return static_cast<std::uint32_t>(move);
+            }
+
+            _stage = stage::captures_losing;
+            [[fallthrough]];
+        }
+        case stage::captures_losing:
+        {
+            while (_captures_cur < _captures_end)
+            {
+                const std::int64_t move { pick_best(_captures_cur++, _captures_end) };
+                if (!is_already_played(move))
+                    return static_cast<std::uint32_t>(move);
+            }
+
+            _stage = stage::done;
+            return move::NULL_MOVE;
+        }
+        case stage::quiescent_generate:
+        {
+            _end = generate_pseudo_legal_loud_moves(_gs.bb, _move_buf);
+            for (std::size_t i = 0; i < _end; i++)
+                score_quiescent(_move_buf[i]);
+
+            _stage = stage::quiescent;
+            [[fallthrough]];
+        }
+        case stage::quiescent:
+        {
+            if (_captures_cur < _end)
+                return static_cast<std::uint32_t>(pick_best(_captures_cur++, _end));
+
+            _stage = stage::done;
+            return move::NULL_MOVE;
+        }
+        case stage::done:
+            break;
+    }
+
+    return move::NULL_MOVE;
+}
+
+}
@@ -7,10 +7,13 @@
 #include "evaluation/evaluate.hpp"
 #include "position/game_state.hpp"
 #include "position/generate_moves.hpp"
+#include "search/limits.hpp"
 #include "search/search_negamax.hpp"
 #include "search/statistics.hpp"
+#include "search/time_manager.hpp"
 
 #include <chrono>
+#include <limits>
 
 namespace search
 {
@@ -24,8 +27,14 @@ struct recommendation
     friend constexpr bool operator>(const recommendation& a, const recommendation& b) noexcept { return a.eval > b.eval; };
 };
 
-recommendation recommend_move(game_state& gs, statistics& stats, std::size_t max_depth = 64, std::chrono::duration<double> max_time = std::chrono::hours(2));
-recommendation recommend_move(game_state& gs, std::size_t max_depth = 64, std::chrono::duration<double> max_time = std::chrono::hours(2));
+// Recommends a move for the current position by running an iterative-deepening search. If more than one thread is requested
+// the search is lazy-SMP, with the additional helper threads searching their own copies of the game-state and sharing only
+// the transposition table with the main thread (whose result is the one returned). The search either runs for a fixed
+// maximum time, or within the given limits for as long as the time manager decides.
+recommendation recommend_move(game_state& gs, statistics& stats, std::size_t max_depth = 64, std::chrono::duration<double> max_time = std::chrono::hours(2), std::size_t threads = 1);
+recommendation recommend_move(game_state& gs, std::size_t max_depth = 64, std::chrono::duration<double> max_time = std::chrono::hours(2), std::size_t threads = 1);
+recommendation recommend_move(game_state& gs, statistics& stats, const limits& lim, time_manager tm, std::size_t threads = 1);
+recommendation recommend_move(game_state& gs, const limits& lim, time_manager tm, std::size_t threads = 1);
 
 }
 
@@ -34,6 +43,8 @@ recommendation recommend_move(game_state& gs, std::size_t max_depth = 64, std::c
 // ####################################
 
 #include <future>
+#include <thread>
+#include <vector>
 
 namespace search
 {
@@ -41,8 +52,9 @@ namespace search
 namespace details
 {
 
-// Is used by the iterative-deepening recommend-move call.
-inline recommendation recommend_move_impl(game_state& gs, statistics& stats, std::size_t depth)
+// Is used by the iterative-deepening recommend-move call. Helper threads don't log anything and only contribute their node
+// counts to the statistics.
+inline recommendation recommend_move_impl(game_state& gs, statistics& stats, std::size_t depth, bool is_helper = false)
 {
     std::array<std::int64_t, static_cast<std::size_t>(::details::pv_table::MAX_DEPTH*MAX_MOVES_PER_POSITION)> move_buf;
     std::span<std::int64_t> move_span(move_buf);
@@ -64,9 +76,17 @@ inline recommendation recommend_move_impl(game_state& gs, statistics& stats, std
 
     stats_local.eval = score;
     stats_local.time = end - start;
-    stats_local.pv = gs.get_pv(0);
+
+    // The nodes searched by helpers still count towards our NPS even if they were stopped part way through an iteration.
+    if (is_helper)
+    {
+        stats.smp_update(stats_local);
+        return { .move=gs.pv.table[0][0], .eval=score };
+    }
 
     // Log and update our search info if we weren't stopped.
+    stats_local.pv = gs.get_pv(0);
+    stats_local.tt_hashfull = gs.tt->get_hashfull(gs.age);
     if (!gs.stop_search)
     {
         stats_local.log_search_info();
@@ -76,19 +96,54 @@ inline recommendation recommend_move_impl(game_state& gs, statistics& stats, std
     return { .move=gs.pv.table[0][0], .eval=score };
 }
 
-inline recommendation recommend_move_id_impl(game_state& gs, statistics& stats, std::size_t depth)
+// The iterative deepening of a lazy-SMP helper thread. Helpers only contribute through the entries they store in the shared
+// transposition table, so we start every other helper one ply deeper to stop all the threads searching the same depth in
+// lock-step.
+inline void recommend_move_helper_impl(game_state& gs, statistics& stats, std::size_t depth, std::size_t id)
+{
+    for (std::size_t i = 1 + id%2; i <= depth && !gs.stop_search; i++)
+        recommend_move_impl(gs, stats, i, true);
+}
+
+inline recommendation recommend_move_id_impl(game_state& gs, statistics& stats, const limits& lim, std::size_t threads, time_manager& tm)
 {
     gs.stop_search = false;
     gs.prepare_new_search();
+    gs.root_moves = lim.root_moves;
+
+    // The node budget is set for each iteration of the main thread below - the helpers have unlimited copies of it.
+    gs.node_limit = std::numeric_limits<std::size_t>::max();
+
+    // A mate in n moves is found by the time we search 2n ply deep, when the mated side has no moves.
+    const std::size_t depth { lim.mate ? std::min(lim.depth, 2*lim.mate) : lim.depth };
 
     // Handle the special case of 0-depth search (raw terminal evaluation).
     if (depth == 0)
         return recommend_move_impl(gs, stats, 0);
 
+    // Kick-off our helper threads. Each gets its own copy of the game-state (and so its own PV, killer, and history tables) but
+    // the copies all share our transposition table.
+    std::vector<game_state> helper_gs(std::max<std::size_t>(threads, 1)-1, gs);
+    std::vector<statistics> helper_stats(helper_gs.size());
+    std::vector<std::thread> helpers;
+    for (std::size_t i = 0; i < helper_gs.size(); i++)
+        helpers.emplace_back(&recommend_move_helper_impl, std::ref(helper_gs[i]), std::ref(helper_stats[i]), depth, i+1);
+
     // Do the iterative deepening - we make sure to only update our recommendation if we weren't interrupted.
     recommendation ret {};
+    const std::size_t nodes_start { stats.get_nodes() };
     for (std::size_t i = 1; i <= depth; i++)
     {
+        // Each iteration counts its own nodes, so gets whatever is left of the node budget. The first iteration is always
+        // allowed to finish, so that we've got a move to play.
+        const std::size_t nodes { stats.get_nodes() - nodes_start };
+        if (i > 1 && lim.nodes != std::numeric_limits<std::size_t>::max())
+        {
+            if (nodes >= lim.nodes)
+                break;
+            gs.node_limit = lim.nodes - nodes;
+        }
+
         const recommendation id = details::recommend_move_impl(gs, stats, i);
         if (gs.stop_search)
             break;
@@ -97,20 +152,35 @@ inline recommendation recommend_move_id_impl(game_state& gs, statistics& stats,
         // If we've found checkmate we return immediately.
         if (std::abs(id.eval) >= evaluation::EVAL_CHECKMATE)
             break;
+
+        // Otherwise the time manager decides whether the next iteration is worth starting, given the score relative to us.
+        if (!tm.update(stats, id.move, gs.bb.is_black_to_play() ? -id.eval : id.eval))
+            break;
     }
 
+    // Our helpers only run for as long as the main thread does.
+    for (auto& helper : helper_gs)
+        helper.stop_search = true;
+    for (auto& helper : helpers)
+        helper.join();
+    for (const auto& helper : helper_stats)
+        stats.smp_update(helper);
+
     gs.stop_search = true;
     return ret;
 }
 
 }
 
-inline recommendation recommend_move(game_state& gs, statistics& stats, std::size_t max_depth, std::chrono::duration<double> max_time)
+inline recommendation recommend_move(game_state& gs, statistics& stats, const limits& lim, time_manager tm, std::size_t threads)
 {
-    auto f = std::async(&details::recommend_move_id_impl, std::ref(gs), std::ref(stats), max_depth);
+    tm.start();
+    const auto hard_limit { tm.get_hard_limit() };
+
+    auto f = std::async(&details::recommend_move_id_impl, std::ref(gs), std::ref(stats), std::cref(lim), threads, std::ref(tm));
 
-    // See if we finished early (e.g. found mate).
-    if (f.wait_for(max_time) == std::future_status::ready)
+    // See if we finished early (e.g. found mate, or the time manager stopped between iterations).
+    if (!hard_limit || f.wait_for(*hard_limit) == std::future_status::ready)
         return f.get();
 
     // Otherwise we just stop and return.
@@ -118,10 +188,20 @@ inline recommendation recommend_move(game_state& gs, statistics& stats, std::siz
     return f.get();
 }
 
-inline recommendation recommend_move(game_state& gs, std::size_t max_depth, std::chrono::duration<double> max_time)
+inline recommendation recommend_move(game_state& gs, const limits& lim, time_manager tm, std::size_t threads)
+{
+    statistics stats_dummy {};
+    return recommend_move(gs, stats_dummy, lim, std::move(tm), threads);
+}
+
+inline recommendation recommend_move(game_state& gs, statistics& stats, std::size_t max_depth, std::chrono::duration<double> max_time, std::size_t threads)
+{
+    return recommend_move(gs, stats, { .depth=max_depth }, time_manager::fixed(max_time), threads);
+}
+
+inline recommendation recommend_move(game_state& gs, std::size_t max_depth, std::chrono::duration<double> max_time, std::size_t threads)
 {
-    statistics stats_dummy;
-    return recommend_move(gs, stats_dummy, max_depth, max_time);
+    return recommend_move(gs, { .depth=max_depth }, time_manager::fixed(max_time), threads);
 }
 
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "pieces/pieces.hpp"
 #include "position/game_state.hpp"
 #include "position/move.hpp"
+#include "search/move_picker.hpp"
 #include "search/statistics.hpp"
 #include "search/search_quiescent.hpp"
 
@@ -28,77 +29,6 @@ constexpr std::uint8_t META_EXACT       { 0 };
 constexpr std::uint8_t META_LOWER_BOUND { 1 };
 constexpr std::uint8_t META_UPPER_BOUND { 2 };
 
-inline void score_move(std::int64_t& move, std::size_t draft, const game_state& gs, std::uint32_t pv_move, std::uint32_t hash_move) noexcept
-{
-    constexpr int32_t score_pv              { std::numeric_limits<int32_t>::max()/2 };
-    constexpr int32_t score_hash            { score_pv-1 };
-    constexpr int32_t score_promote_queen   { score_hash-1 };
-    constexpr int32_t score_capture_winning { score_promote_queen-1-details::mvv_lva_score_max };
-    constexpr int32_t score_killer          { score_capture_winning-1+details::mvv_lva_score_min };
-    constexpr int32_t score_capture_loosing { score_killer-1-details::mvv_lva_score_max };
-    constexpr int32_t score_promote_other   { score_capture_loosing-1+details::mvv_lva_score_min };
-    constexpr int32_t score_history         { 0 };
-
-    int64_t score;
-    if (move::move_is_equal(move, pv_move))
-    {
-        move |= move::info::PV;
-        score = score_pv;
-    }
-    else if (move::move_is_equal(move, hash_move))
-    {
-        move |= move::info::HASH;
-        score = score_hash;
-    }
-    else if (move & move::type::PROMOTION)
-    {
-        score = ((move::make_decode_promotion(move) & 0x07) == piece_idx::w_queen) ? score_promote_queen : score_promote_other;
-    }
-    else if (move & move::type::CAPTURE)
-    {
-        // Score captures according to MVV/LVA score. Captures are divided into winning and loosing buckets according to their SEE, with winning
-        // captures being defined as having a positive SEE with some delta-flexibility.
-        constexpr int32_t winning_capture_see_delta { -100 };
-        const bool winning_capture = (evaluation::see_capture(gs.bb, move)) > winning_capture_see_delta;
-
-        const int32_t mvv_lva { mvv_lva_score(gs.bb, move) };
-        score = (winning_capture ? score_capture_winning : score_capture_loosing) + mvv_lva;
-    }
-    else if (config::km && gs.km.is_killer_move(draft, move))
-    {
-        move |= move::info::KILLER;
-        score = score_killer;
-    }
-    else if (config::hh)
-    {
-        score = score_history + gs.hh.get_bonus(move);
-    }
-    else
-    {
-        score = 0;
-    }
-
-    // Tag the move if it leaves the other side in check - we might do this more efficiently soon.
-    {
-        bitboard bb_copy = gs.bb;
-        make_move({ .check_legality=false }, bb_copy, move);
-        if (is_in_check(bb_copy))
-            move |= move::info::CHECK;
-    }
-
-    // Set the score.
-    move |= static_cast<std::int64_t>(score << 32);
-}
-
-inline void sort_moves(std::span<std::int64_t> move_buf, std::size_t draft, const game_state& gs, std::uint32_t pv_move, std::uint32_t hash_move) noexcept
-{
-    // Score each move and fill-out the move-info.
-    std::for_each(move_buf.begin(), move_buf.end(), [&gs, draft, pv_move, hash_move] (std::int64_t& move) { score_move(move, draft, gs, pv_move, hash_move); });
-
-    // Sort the moves (high-to-low).
-    std::sort(move_buf.rbegin(), move_buf.rend());
-}
-
 inline void handle_fail_high(game_state& gs, std::size_t draft, std::uint32_t move)
 {
     // Handle quiet moves that fail-high.
@@ -118,40 +48,44 @@ inline int search_negamax_recursive(game_state& gs, statistics& stats, std::size
     const size_t draft { gs.bb.ply_counter-gs.root_ply };
     // const bool is_pv { beta - alpha > 1};
 
-    // Update stats.
+    // Update stats, stopping the search once we've used up our node budget.
     stats.abnodes++;
+    if (stats.get_nodes() >= gs.node_limit) [[unlikely]]
+        gs.stop_search = true;
 
     // Handle repetition-based draws first - we currently don't implement and contempt factor when playing against weaker opponents.
     // It is faster doing this here before the hash-lookup as in practice almost all hash-lookups will probably result in a cache-miss.
     if (gs.is_repetition_draw()) [[unlikely]]
         return 0;
 
-    // Loop up the value in the hash table.
+    // Loop up the value in the hash table. Entries only keep part of the hash, so we treat a hit whose move couldn't be played
+    // here as a collision with a different position.
     stats.tt_probes++;
-    auto& entry { gs.tt[gs.hash] };
-    const bool hash_hit { entry.key == gs.hash };
+    ::details::search_value_type entry {};
+    const bool hash_hit { gs.tt->probe(gs.hash, entry) && (!entry.best_move || is_pseudo_legal(gs.bb, entry.best_move)) };
     if (hash_hit)
         stats.tt_hits++;
 
-    // Only consider returning early if our hash entry is the right age (i.e. is from this search) and has a higher depth (i.e. lower
-    // draft) than this current node.
-    if (hash_hit && entry.value.age == gs.age && entry.value.depth >= depth)
+    // Only consider returning early if our hash entry has a higher depth (i.e. lower draft) than this current node. Entries
+    // from previous searches are just as good as ours (the age only decides what gets replaced first), but we never cut at the
+    // root as we always need to search for a move to play there.
+    if (hash_hit && draft > 0 && entry.depth >= depth)
     {
-        const int eval { entry.value.eval };
+        const int eval { entry.eval };
 
         // PV-node.
-        if (entry.value.meta == META_EXACT)
+        if (entry.meta == META_EXACT)
         {
             // We have an exact score - lucky us! We might be able to retrieve a PV from it as well!
             stats.pvnodes++;
-            if (entry.value.best_move)
-                gs.pv.table[draft][0] = entry.value.best_move;
+            if (entry.best_move)
+                gs.pv.table[draft][0] = entry.best_move;
             return eval;
         }
 
         // All-node (fail-low). We have an upperbound for how good this move can be. If this is less than our alpha there's no point in
         // continuing this search.
-        if (entry.value.meta == META_UPPER_BOUND && eval <= alpha)
+        if (entry.meta == META_UPPER_BOUND && eval <= alpha)
         {
             stats.allnodes++;
             return eval;
@@ -159,18 +93,18 @@ inline int search_negamax_recursive(game_state& gs, statistics& stats, std::size
 
         // Cut-node (fail-high). We have a lowerbound for how good this move can be. If this is greater than our beta, there's no point
         // in trying to find a stronger refutation.
-        if (entry.value.meta == META_LOWER_BOUND && eval >= beta)
+        if (entry.meta == META_LOWER_BOUND && eval >= beta)
         {
             stats.cutnodes++;
             stats.fh_hash++;
-            if (const std::uint32_t best_move { entry.value.best_move }; best_move) handle_fail_high(gs, draft, best_move);
+            if (const std::uint32_t best_move { entry.best_move }; best_move) handle_fail_high(gs, draft, best_move);
             return eval;
         }
     }
 
     // Look up our PV and hash moves from previous searches.
     const std::uint32_t pv_move        { gs.pv.table[draft][0] };
-    const std::uint32_t hash_move      { hash_hit ? entry.value.best_move : 0 };
+    const std::uint32_t hash_move      { hash_hit ? entry.best_move : 0 };
     const bool in_check                { is_in_check(gs.bb, colour == -1) };
     const bool is_king_and_pawn_colour { gs.bb.is_king_and_pawn(colour == -1) };
 
@@ -184,7 +118,7 @@ inline int search_negamax_recursive(game_state& gs, statistics& stats, std::size
     else
     {
         // See if we can perform null-move pruning - this relies on not being in check or a king-and-pawn endgame.
-        const std::size_t r { depth > 6 ? 4ULL : 3ULL };
+        const std::size_t r { static_cast<std::size_t>(config::nmp_reduction) + (depth > static_cast<std::size_t>(config::nmp_reduction_depth)) };
         bool null_move_pruned { false };
         if (config::nmp && !in_check && !is_king_and_pawn_colour && depth >= r+1)
         // if (config::nmp && !in_check && !is_king_and_pawn_colour && depth >= r)
@@ -211,19 +145,14 @@ inline int search_negamax_recursive(game_state& gs, statistics& stats, std::size
         // Continue with the rest of our search if we were unable to prune any nodes.
         if (!null_move_pruned)
         {
-            // Otherwise, we need to continue the search by generating all nodes from here.
-            const std::size_t moves { generate_pseudo_legal_moves(gs.bb, move_buf) };
-            const auto move_list = move_buf.subspan(0, moves);
-
-            // Sort the moves favourably to increase the chance of early beta-cutoffs.
-            sort_moves(move_list, draft, gs, pv_move, hash_move);
-
-            for (std::size_t i = 0; i < moves; i++)
+            // Go through the moves best-first, only generating (and scoring) them as and when we need them. The index counts the moves
+            // we've tried so far (legal or not), which drives our reductions.
+            move_picker picker(gs, move_buf, draft, hash_move, pv_move);
+            std::size_t i {};
+            for (std::uint32_t make; (make = picker.next()); i++)
             {
                 stats.moves_all++;
 
-                const auto make = move_list[i];
-
                 // Allow us to break out of the search early if needed.
                 if (gs.stop_search) [[unlikely]]
                     return ret;
@@ -238,11 +167,12 @@ inline int search_negamax_recursive(game_state& gs, statistics& stats, std::size
                     continue;
                 }
 
-                // We run the recursive search at a lower depth if this move isn't near the top of our list after sorting. TODO: have smarter
-                // adaptive LMR-reduction, and tweek the LMR kick-in.
+                // We run the recursive search at a lower depth if this move isn't near the top of our list after sorting (and doesn't
+                // give check). TODO: have smarter adaptive LMR-reduction, and tweek the LMR kick-in.
                 const bool do_lmr { config::lmr && i >= 2 && depth > 2 && !(make & (move::info::KILLER | move::info::CHECK)) };
-                const std::size_t lmr_reduction { static_cast<std::size_t>(0.99 + std::log(depth) * std::log(i) / 3.14) };
-                const std::size_t d { do_lmr ? depth-lmr_reduction-1 : depth-1 };
+                const std::size_t lmr_reduction { static_cast<std::size_t>(config::lmr_base/100.0 + std::log(depth) * std::log(i) / (config::lmr_divisor/100.0)) };
+                // Tuned LMR constants can ask for more reduction than we have depth left, so we cap it at dropping into quiescence.
+                const std::size_t d { do_lmr ? depth-1-std::min(lmr_reduction, depth-1) : depth-1 };
                 if (do_lmr)
                     stats.moves_lmr++;
 
@@ -251,19 +181,20 @@ inline int search_negamax_recursive(game_state& gs, statistics& stats, std::size
                 if (do_scout)
                     stats.moves_pvs++;
 
-                // Recurse negamax.
-                int score = -search_negamax_recursive(gs, stats, d, -b, -alpha, -colour, move_buf.subspan(moves));
+                // Recurse negamax - the children put their moves after the ones we've generated so far.
+                const std::span<std::int64_t> child_buf { picker.get_unused_buf() };
+                int score = -search_negamax_recursive(gs, stats, d, -b, -alpha, -colour, child_buf);
 
                 // Handle researching at full-depth / widened window if necessary.
                 if (do_scout && alpha < score && score < beta && depth > 0)
                 {
                     stats.pvs_researches++;
-                    score = -search_negamax_recursive(gs, stats, depth-1, -beta, -score, -colour, move_buf.subspan(moves));
+                    score = -search_negamax_recursive(gs, stats, depth-1, -beta, -score, -colour, child_buf);
                 }
                 else if (do_lmr && score > alpha)
                 {
                     stats.lmr_researches++;
-                    score = -search_negamax_recursive(gs, stats, depth-1, -beta, -alpha, -colour, move_buf.subspan(moves));
+                    score = -search_negamax_recursive(gs, stats, depth-1, -beta, -alpha, -colour, child_buf);
                 }
 
                 // Resets the game state to how it was before we made the move.
@@ -306,35 +237,38 @@ inline int search_negamax_recursive(game_state& gs, statistics& stats, std::size
         }
     }
 
-    // Handle updating our transposition table. We currently employ the very simple strategy of always overwriting unless the other
-    // entry recent (i.e. not from a previous search) and was at a higher depth.
-    if (!hash_hit || entry.value.age != gs.age || entry.value.depth <= depth)
+    // Handle updating our transposition table. We always overwrite the entry for this position unless it was recent (i.e. from
+    // this search) and at a higher depth - otherwise the table picks the least valuable entry in the bucket to replace. A root
+    // restricted to some of its moves (e.g. UCI searchmoves) only has a score for those moves, so it's never stored.
+    const bool is_restricted_root { draft == 0 && !gs.root_moves.empty() };
+    if (!is_restricted_root && (!hash_hit || entry.age != gs.age || entry.depth <= depth))
     {
         // Set basic parameters.
-        entry.key         = gs.hash;
-        entry.value.age   = gs.age;
-        entry.value.depth = depth;
-        entry.value.eval  = ret;
+        entry.age   = gs.age;
+        entry.depth = depth;
+        entry.eval  = ret;
 
         // Set the best move if we've at least raised our alpha.
-        entry.value.best_move = (ret > alpha_orig ? best_move : 0);
+        entry.best_move = (ret > alpha_orig ? best_move : 0);
 
         // Set our node-type.
         if (ret <= alpha_orig)
         {
             stats.allnodes++;
-            entry.value.meta = META_UPPER_BOUND;
+            entry.meta = META_UPPER_BOUND;
         }
         else if (ret >= beta)
         {
             stats.cutnodes++;
-            entry.value.meta = META_LOWER_BOUND;
+            entry.meta = META_LOWER_BOUND;
         }
         else
         {
             stats.pvnodes++;
-            entry.value.meta = META_EXACT;
+            entry.meta = META_EXACT;
         }
+
+        gs.tt->store(gs.hash, entry);
     }
 
     return ret;
@@ -352,10 +286,10 @@ inline int search_negamax(game_state& gs, statistics& stats, std::size_t depth,
         return details::search_negamax_recursive(gs, stats, depth, a, b, colour, move_buf);
 
     // Set a narrower window around the previous score for this node if we can find it in the transposition table.
-    if (const auto& entry { gs.tt[gs.hash] }; entry.key == gs.hash)
+    if (::details::search_value_type entry; gs.tt->probe(gs.hash, entry))
     {
-        a = entry.value.eval-d;
-        b = entry.value.eval+d;
+        a = entry.eval-d;
+        b = entry.eval+d;
     }
 
     while (true)
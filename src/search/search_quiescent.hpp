@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pieces/pieces.hpp"
+#include "search/move_picker.hpp"
 #include "search/statistics.hpp"
 
 #include "evaluation/see.hpp"
@@ -15,55 +16,24 @@
 namespace search
 {
 
-namespace details
+// The static evaluation of the position (from white's perspective), from the evaluation cache if we have it.
+inline int evaluate_cached(const game_state& gs, statistics& stats) noexcept
 {
+    if constexpr (!config::eval_cache)
+        return gs.evaluate();
 
-inline int mvv_lva_score(const bitboard& bb, std::uint32_t move)
-{
-    // Multiplying the victim score ensures it's the dominant term.
-    constexpr int victim_attacker_ratio { 10 };
-
-    // Handle the special case of en-passent capture.
-    if (move & move::type::EN_PASSENT) [[unlikely]]
-        return victim_attacker_ratio-1;
-
-    const auto attacker = move::make_decode_piece_idx(move);
-    const auto victim   = bb.get_piece_type_colour(1ULL << move::make_decode_to_mb(move), !bb.is_black_to_play());
-
-    const int victim_val   { std::abs(::evaluation::piece_mg_evaluation[victim]) };
-    const int attacker_val { std::abs(::evaluation::piece_mg_evaluation[attacker]) };
-
-    // Multiplying the victim score ensures it's the dominant term.
-    return victim_attacker_ratio*victim_val - attacker_val;
-}
-
-constexpr int mvv_lva_score_min   { 10*::evaluation::piece_mg_evaluation[piece_idx::w_pawn]  - ::evaluation::piece_mg_evaluation[piece_idx::w_queen] };
-constexpr int mvv_lva_score_max   { 10*::evaluation::piece_mg_evaluation[piece_idx::w_queen] - ::evaluation::piece_mg_evaluation[piece_idx::w_pawn]  };
-constexpr int mvv_lva_score_range { mvv_lva_score_max - mvv_lva_score_min };
-
-inline void score_movequiescent(std::int64_t& move, const game_state& gs) noexcept
-{
-    constexpr int32_t score_promotion { std::numeric_limits<int>::max()/2 };
-
-    int64_t score;
-    if (move & move::type::PROMOTION) [[unlikely]]
-        score = score_promotion;
-    else
-        score = mvv_lva_score(gs.bb, move);
+    stats.eval_cache_probes++;
 
-    // Set the score.
-    move |= static_cast<std::int64_t>(score << 32);
-}
-
-inline void sort_moves_quiescent(std::span<std::int64_t> move_buf, const game_state& gs) noexcept
-{
-    // Score each move and fill-out the move-info.
-    std::for_each(move_buf.begin(), move_buf.end(), [&gs] (std::int64_t& move) { score_movequiescent(move, gs); });
-
-    // Sort the moves (high-to-low).
-    std::sort(move_buf.rbegin(), move_buf.rend());
-}
+    std::int64_t eval;
+    if (gs.eval_cache->probe(gs.hash, eval))
+    {
+        stats.eval_cache_hits++;
+        return static_cast<int>(eval);
+    }
 
+    const int ret { gs.evaluate() };
+    gs.eval_cache->store(gs.hash, ret);
+    return ret;
 }
 
 inline int search_quiescence(game_state& gs, statistics& stats, std::size_t draft, int a, int b, int colour, std::span<std::int64_t> move_buf) noexcept
@@ -72,7 +42,7 @@ inline int search_quiescence(game_state& gs, statistics& stats, std::size_t draf
     stats.qdepth = std::max(stats.qdepth, draft);
 
     // Stand-pat evaluation (side to move perspective).
-    const int stand_pat = colour*gs.evaluate();
+    const int stand_pat = colour*evaluate_cached(gs, stats);
 
     // Fail-hard beta cutoff.
     int best_value { stand_pat };
@@ -81,14 +51,9 @@ inline int search_quiescence(game_state& gs, statistics& stats, std::size_t draf
 
     a = std::max(a, best_value);
 
-    // Generate "noisy" moves (for now just captures).
-    const std::size_t moves { generate_pseudo_legal_loud_moves(gs.bb, move_buf) };
-    const auto move_list = move_buf.subspan(0, moves);
-
-    // Sort quiescent moves.
-    details::sort_moves_quiescent(move_list, gs);
-
-    for (const auto make : move_list)
+    // Only go through the "noisy" moves (for now just captures and promotions).
+    move_picker picker(gs, move_buf);
+    for (std::uint32_t make; (make = picker.next()); )
     {
         if (gs.stop_search) [[unlikely]]
             return best_value;
@@ -101,12 +66,11 @@ inline int search_quiescence(game_state& gs, statistics& stats, std::size_t draf
                 continue;
 
             // Delta-prunning.
-            if (!(make & move::type::EN_PASSENT) || !evaluation::is_late_endgame(gs.bb)) [[likely]]
+            if (!(make & move::type::EN_PASSENT) || !evaluation::is_late_endgame(gs.piece_square_eval.gp)) [[likely]]
             {
-                constexpr int delta { 200 };
-                const auto victim = gs.bb.get_piece_type_colour(1ULL << move::make_decode_to_mb(make), !gs.bb.is_black_to_play());
+                const auto victim = gs.bb.get_piece_type_mb(move::make_decode_to_mb(make));
                 const int victim_val { std::abs(::evaluation::piece_mg_evaluation[victim]) };
-                if (victim_val + delta + stand_pat < a) [[unlikely]]
+                if (victim_val + config::delta_margin + stand_pat < a) [[unlikely]]
                     continue;
             }
         }
@@ -118,7 +82,7 @@ inline int search_quiescence(game_state& gs, statistics& stats, std::size_t draf
             continue;
         }
 
-        int score = -search_quiescence(gs, stats, draft+1, -b, -a, -colour, move_buf.subspan(moves));
+        int score = -search_quiescence(gs, stats, draft+1, -b, -a, -colour, picker.get_unused_buf());
         unmake_move(gs, make, unmake);
 
         a = std::max(a, score);
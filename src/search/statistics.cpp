@@ -15,6 +15,7 @@ void statistics::log_search_info() const
     ss << "depth "                 << static_cast<int>(depth)
        << " score cp "             << eval
        << " time "                 << duration_ms
+       << " hashfull "             << tt_hashfull
        << " nodes "                << get_nodes()
        << " nps "                  << get_nps()
        << " abnodes "              << abnodes
@@ -45,6 +46,9 @@ void statistics::log_search_info() const
        << " tt-probes "            << tt_probes
        << " tt-hits "              << tt_hits
        << " tt-hit-rate "          << std::setprecision(2) << get_tt_hit_rate()
+       << " eval-cache-probes "    << eval_cache_probes
+       << " eval-cache-hits "      << eval_cache_hits
+       << " eval-cache-hit-rate "  << std::setprecision(2) << get_eval_cache_hit_rate()
        << " aw-misses-low "        << aw_misses_low
        << " aw-misses-high "       << aw_misses_high
        << " aw-misses-total "      << get_aw_misses_total()
@@ -64,6 +68,19 @@ void statistics::id_update(const statistics& v)
     eval = v.eval;
     pv   = v.pv;
 
+    tt_hashfull = v.tt_hashfull;
+
+    prev_iteration_nodes = iteration_nodes;
+    iteration_nodes      = v.get_nodes();
+    iteration_time       = v.time;
+
+    smp_update(v);
+
+    time += v.time;
+}
+
+void statistics::smp_update(const statistics& v)
+{
     abnodes  += v.abnodes;
     qnodes   += v.qnodes;
     cutnodes += v.cutnodes;
@@ -86,14 +103,15 @@ void statistics::id_update(const statistics& v)
     tt_probes += v.tt_probes;
     tt_hits   += v.tt_hits;
 
+    eval_cache_probes += v.eval_cache_probes;
+    eval_cache_hits   += v.eval_cache_hits;
+
     aw_misses_low  += v.aw_misses_low;
     aw_misses_high += v.aw_misses_high;
 
     pvs_researches += v.pvs_researches;
 
     lmr_researches += v.lmr_researches;
-
-    time += v.time;
 }
 
 }
\ No newline at end of file
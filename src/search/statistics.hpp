@@ -58,6 +58,13 @@ struct statistics
     std::size_t tt_probes {};
     std::size_t tt_hits   {};
     double get_tt_hit_rate() const noexcept { return static_cast<double>(tt_hits) / static_cast<double>(tt_probes); }
+    // Permille of the transposition table written to during this search (sampled at the end of each ID iteration).
+    std::size_t tt_hashfull {};
+
+    // Evaluation-cache metrics.
+    std::size_t eval_cache_probes {};
+    std::size_t eval_cache_hits   {};
+    double get_eval_cache_hit_rate() const noexcept { return static_cast<double>(eval_cache_hits) / static_cast<double>(eval_cache_probes); }
 
     // The number of misses of our aspiration window (both lower and upper).
     std::size_t aw_misses_low  {};
@@ -79,11 +86,22 @@ struct statistics
 
     std::size_t get_nps() const noexcept { return static_cast<std::size_t>(static_cast<double>(get_nodes()) / std::chrono::duration<double>(time).count()); }
 
+    // The nodes and time of the last completed ID iteration, and the nodes of the one before it. Their ratio is the
+    // effective branching factor, used to predict how long the next iteration will take (0 until there are two iterations).
+    std::size_t iteration_nodes      {};
+    std::size_t prev_iteration_nodes {};
+    std::chrono::steady_clock::duration iteration_time {};
+    double get_branching_factor() const noexcept { return prev_iteration_nodes ? static_cast<double>(iteration_nodes) / static_cast<double>(prev_iteration_nodes) : 0.0; }
+
     // UCI-style statistics logging.
     void log_search_info() const;
 
     // Update the statistics with the another ID search result.
     void id_update(const statistics& v);
+
+    // Accumulate the node and move counters of a helper thread's search, leaving the depth, evaluation, PV, and timing
+    // of the main thread untouched.
+    void smp_update(const statistics& v);
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "time_manager.hpp"
+
+#include <algorithm>
+
+namespace search
+{
+
+time_manager time_manager::fixed(duration time) noexcept
+{
+    time_manager ret;
+    ret._hard = time;
+    return ret;
+}
+
+time_manager time_manager::from_clock(duration remaining, duration increment, std::optional<std::size_t> movestogo) noexcept
+{
+    // We plan to spend an equal share of our time on each move until the next time control, along with half the increment.
+    // The increment is only added after the move, so we never plan on spending it.
+    const duration available { std::max(remaining - MOVE_OVERHEAD, duration::zero()) };
+    const std::size_t moves { std::clamp<std::size_t>(movestogo.value_or(DEFAULT_MOVESTOGO), 1, MAX_MOVESTOGO) };
+    const duration soft { available / static_cast<double>(moves) + increment / 2.0 };
+
+    time_manager ret;
+    ret._hard = std::min(soft * HARD_RATIO, moves == 1 ? available : available * HARD_MAX_USAGE);
+    ret._soft = std::min(soft, *ret._hard);
+    return ret;
+}
+
+void time_manager::start() noexcept
+{
+    _start = std::chrono::steady_clock::now();
+    _scale = 1.0;
+    _iterations = 0;
+    _stable_iterations = 0;
+    _best_move = {};
+    _score = {};
+}
+
+bool time_manager::update(const statistics& stats, std::uint32_t best_move, int score) noexcept
+{
+    // Keep track of how long the best move has been the same, and scale the soft deadline accordingly.
+    if (_iterations > 0)
+    {
+        _stable_iterations = best_move == _best_move ? _stable_iterations+1 : 0;
+
+        if (_stable_iterations == 0)
+            _scale = UNSTABLE_SCALE;
+        else if (_stable_iterations >= 2*STABLE_ITERATIONS)
+            _scale = VERY_STABLE_SCALE;
+        else if (_stable_iterations >= STABLE_ITERATIONS)
+            _scale = STABLE_SCALE;
+        else
+            _scale = 1.0;
+
+        if (score <= _score - SCORE_DROP_MARGIN)
+            _scale *= SCORE_DROP_SCALE;
+    }
+
+    _iterations++;
+    _best_move = best_move;
+    _score = score;
+
+    if (!_hard)
+        return true;
+
+    const duration elapsed { std::chrono::steady_clock::now() - _start };
+    if (const auto soft = get_soft_limit(); soft && elapsed >= *soft)
+        return false;
+
+    // Every iteration takes roughly the branching factor times as long as the last.
+    const double branching_factor { stats.get_branching_factor() > 0.0 ? std::min(stats.get_branching_factor(), MAX_BRANCHING_FACTOR) : DEFAULT_BRANCHING_FACTOR };
+    const duration predicted { duration(stats.iteration_time) * branching_factor };
+    return elapsed + predicted < *_hard;
+}
+
+std::optional<time_manager::duration> time_manager::get_soft_limit() const noexcept
+{
+    if (!_soft)
+        return std::nullopt;
+
+    return std::min(*_soft * _scale, *_hard);
+}
+
+}
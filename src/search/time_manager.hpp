@@ -0,0 +1,85 @@
+#pragma once
+
+#include "search/statistics.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace search
+{
+
+// Decides how long a search runs for. There are two deadlines - the soft deadline is how long we'd like to spend, and is only
+// checked between iterative-deepening iterations, and the hard deadline is the most we can afford, when the search is stopped
+// part way through an iteration. After every iteration the soft deadline is scaled down when the best move has been stable
+// for a few iterations and up when it changes or the score drops, and the next iteration isn't started if the branching
+// factor suggests it wouldn't finish before the hard deadline (as the result of an unfinished iteration is thrown away).
+class time_manager
+{
+public:
+    using duration = std::chrono::duration<double>;
+
+    // A search without any time limits.
+    time_manager() = default;
+
+    // A search of exactly the given time, stopped at the deadline.
+    static time_manager fixed(duration time) noexcept;
+
+    // A search under a clock, with the time remaining and increment of the side to play, and the number of moves until the
+    // next time control (if it isn't sudden death).
+    static time_manager from_clock(duration remaining, duration increment, std::optional<std::size_t> movestogo = std::nullopt) noexcept;
+
+    // Starts the clock, which should be done as the search starts.
+    void start() noexcept;
+
+    // Takes the result of a completed iteration - the statistics of the search so far, and the best move and its score
+    // (relative to the side to play) - and returns whether to start the next iteration.
+    bool update(const statistics& stats, std::uint32_t best_move, int score) noexcept;
+
+    // The deadlines measured from the start of the search, with no hard deadline if the time is unlimited. The soft deadline
+    // includes the scaling from the iterations so far.
+    std::optional<duration> get_hard_limit() const noexcept { return _hard; }
+    std::optional<duration> get_soft_limit() const noexcept;
+
+    // The time reserved for communication with the GUI, taken off the remaining time on the clock.
+    static constexpr duration MOVE_OVERHEAD { 0.02 };
+
+    // Without a movestogo we plan as if there are this many moves until the next time control, and we never plan for more.
+    static constexpr std::size_t DEFAULT_MOVESTOGO { 20 };
+    static constexpr std::size_t MAX_MOVESTOGO     { 50 };
+
+    // The hard deadline is this many times the soft deadline, but never more than this fraction of the remaining time (unless
+    // it's the last move before the time control).
+    static constexpr double HARD_RATIO     { 4.0 };
+    static constexpr double HARD_MAX_USAGE { 0.5 };
+
+    // The soft deadline is scaled down once the best move has been the same for this many iterations, and further down after
+    // twice as many, and scaled up on the iteration the best move changes.
+    static constexpr std::size_t STABLE_ITERATIONS { 3 };
+    static constexpr double STABLE_SCALE        { 0.7 };
+    static constexpr double VERY_STABLE_SCALE   { 0.5 };
+    static constexpr double UNSTABLE_SCALE      { 1.5 };
+
+    // The soft deadline is scaled up if the score drops by at least the margin since the last iteration.
+    static constexpr int SCORE_DROP_MARGIN { 30 };
+    static constexpr double SCORE_DROP_SCALE { 1.5 };
+
+    // The branching factor used to predict the length of the next iteration, when we don't have one to go on (or to keep an
+    // odd iteration from throwing the prediction).
+    static constexpr double DEFAULT_BRANCHING_FACTOR { 2.0 };
+    static constexpr double MAX_BRANCHING_FACTOR     { 8.0 };
+
+private:
+    std::optional<duration> _soft;
+    std::optional<duration> _hard;
+    double _scale { 1.0 };
+
+    std::chrono::steady_clock::time_point _start { std::chrono::steady_clock::now() };
+
+    std::size_t _iterations {};
+    std::size_t _stable_iterations {};
+    std::uint32_t _best_move {};
+    int _score {};
+};
+
+}
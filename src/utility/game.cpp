@@ -1,9 +1,11 @@
 #include "game.hpp"
 
 #include "search/search.hpp"
+#include "utility/logging.hpp"
 
 #include <mutex>
 #include <stdexcept>
+#include <string>
 
 game::game()
 {
@@ -14,6 +16,12 @@ game::~game()
 {
     stop();
 
+    {
+        std::lock_guard<std::mutex> lk(_m);
+        if (_table_work.valid())
+            _table_work.wait();
+    }
+
     {
         std::lock_guard<std::mutex> lk(_m);
         _run = false;
@@ -23,14 +31,14 @@ game::~game()
     _t.join();
 }
 
-void game::search(search_type type, std::size_t max_depth, std::chrono::duration<double> max_time)
+void game::search(search_type type, const search::limits& limits, const search::time_manager& tm)
 {
     {
         std::lock_guard<std::mutex> lk(_m);
         if (_search_params.has_value())
             throw std::runtime_error("Search already ongoing");
 
-        _search_params = { .max_depth=max_depth, .max_time=max_time };
+        _search_params = { .limits=limits, .tm=tm };
         _type = type;
     }
     _c.notify_one();
@@ -41,6 +49,52 @@ void game::stop()
     gs.stop_search = true;
 }
 
+void game::queue_table_work(std::function<void()> work)
+{
+    queue_work(std::move(work), true);
+}
+
+void game::queue_after_table_work(std::function<void()> work)
+{
+    queue_work(std::move(work), false);
+}
+
+void game::queue_work(std::function<void()> work, bool uses_tables)
+{
+    std::lock_guard<std::mutex> lk(_m);
+    _table_work = std::async(std::launch::async, [this, previous = _table_work, work = std::move(work), uses_tables] ()
+    {
+        if (previous.valid())
+            previous.wait();
+
+        // A piece of work that fails is only reported - it mustn't stop the work queued after it (e.g. a readyok) or the
+        // searches waiting on it.
+        try
+        {
+            std::unique_lock<std::mutex> tables(_tables_m, std::defer_lock);
+            if (uses_tables)
+                tables.lock();
+            work();
+        }
+        catch (const std::exception& e)
+        {
+            log("string table work failed (" + std::string(e.what()) + ")", log_level::error);
+        }
+    }).share();
+}
+
+void game::wait_table_work()
+{
+    std::shared_future<void> work;
+    {
+        std::lock_guard<std::mutex> lk(_m);
+        work = _table_work;
+    }
+
+    if (work.valid())
+        work.wait();
+}
+
 void game::run_loop()
 {
     while (true)
@@ -54,8 +108,12 @@ void game::run_loop()
         if (!_run)
             return;
 
-        // Otherwise kick-off a search.
-        const std::uint32_t move { search::recommend_move(gs, _search_params->max_depth, _search_params->max_time).move };
+        // Otherwise kick-off a search once any outstanding table work has finished, keeping any table work queued while we
+        // search from touching the tables until we're done.
+        wait_table_work();
+        std::unique_lock<std::mutex> tables(_tables_m);
+        const std::uint32_t move { search::recommend_move(gs, _search_params->limits, _search_params->tm, threads).move };
+        tables.unlock();
         if (_type == search_go)
             callback_best_move(move);
 
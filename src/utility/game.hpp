@@ -1,10 +1,14 @@
 #pragma once
 
 #include "position/game_state.hpp"
+#include "search/limits.hpp"
+#include "search/time_manager.hpp"
 
 #include <chrono>
 #include <thread>
 #include <condition_variable>
+#include <functional>
+#include <future>
 #include <mutex>
 #include <optional>
 
@@ -22,12 +26,27 @@ public:
     ~game();
 
     enum search_type : std::uint8_t { search_go, search_evaluate };
-    void search(search_type type, std::size_t max_depth, std::chrono::duration<double> max_time = std::chrono::days(2));
+    void search(search_type type, const search::limits& limits, const search::time_manager& tm = {});
 
     void stop();
 
+    // Queues work on our tables (e.g. resizing or clearing the transposition table) to run in the background, in the order
+    // it was queued, so the caller is never blocked. Searches wait for all queued table work to finish before starting, and
+    // table work waits for any running search to finish before touching the tables. Work that throws is logged and skipped.
+    void queue_table_work(std::function<void()> work);
+
+    // Queues work that doesn't touch the tables (e.g. a readyok) to run once all the table work queued before it is done. It
+    // doesn't wait for a running search itself.
+    void queue_after_table_work(std::function<void()> work);
+
+    // Waits for all the table work queued so far, e.g. before touching the tables from outside a search.
+    void wait_table_work();
+
     game_state gs;
 
+    // The number of threads used in the (lazy-SMP) search.
+    std::size_t threads { 1 };
+
     void (*callback_best_move)(std::uint32_t);
 
 private:
@@ -38,12 +57,18 @@ private:
 
     struct search_parameters
     {
-        std::size_t max_depth;
-        std::chrono::duration<double> max_time;
+        search::limits limits;
+        search::time_manager tm;
     };
     std::optional<search_parameters> _search_params;
     search_type _type;
 
+    // The last piece of table work queued - each piece waits on the one before it.
+    std::shared_future<void> _table_work;
+
+    // Held by a search for as long as it runs, and by table work while it touches the tables.
+    std::mutex _tables_m;
 
+    void queue_work(std::function<void()> work, bool uses_tables);
     void run_loop();
 };
\ No newline at end of file
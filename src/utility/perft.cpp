@@ -1,31 +1,53 @@
 #include "perft.hpp"
 
+#include "evaluation/evaluate.hpp"
 #include "position/generate_moves.hpp"
 #include "position/make_move.hpp"
 #include "position/move.hpp"
 #include "details/hash_table.hpp"
+#include "position/mailbox.hpp"
 #include "position/zobrist_hash.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 namespace
 {
 
+// Moves from the legal generator don't need their legality checking when they're made. The side to play alternates with
+// every ply, so we carry it down the tree as a template parameter rather than checking it at every node. When bulk-counting,
+// the number of nodes one ply above the leaves is just the number of legal moves.
+template <perft_generator Generator, bool Bulk, bool Black>
 std::size_t perft_recursive_unmake_no_hash(bitboard& bb, std::size_t depth, std::span<std::uint32_t> move_buf)
 {
+    if constexpr (Bulk)
+    {
+        if (depth == 1)
+            return generate_legal_moves<Black>(bb, move_buf);
+    }
+
     if (depth == 0) [[unlikely]]
         return 1;
 
     std::size_t ret {};
 
-    const std::size_t moves { generate_pseudo_legal_moves(bb, move_buf) };
+    constexpr bool is_legal { Generator == perft_generator::legal };
+    const std::size_t moves { is_legal ? generate_legal_moves<Black>(bb, move_buf) : generate_pseudo_legal_moves<Black>(bb, move_buf) };
     const std::span<std::uint32_t> move_list = move_buf.subspan(0, moves);
 
     for (const auto make : move_list)
     {
         std::uint32_t unmake;
-        if (make_move({ .check_legality = true }, bb, make, unmake)) [[likely]]
-            ret += perft_recursive_unmake_no_hash(bb, depth-1, move_buf.subspan(moves));
+        if (make_move<Black>({ .check_legality = !is_legal }, bb, make, unmake)) [[likely]]
+            ret += perft_recursive_unmake_no_hash<Generator, Bulk, !Black>(bb, depth-1, move_buf.subspan(moves));
 
-        unmake_move(bb, make, unmake);
+        unmake_move<Black>(bb, make, unmake);
     }
 
     return ret;
@@ -39,34 +61,40 @@ struct perft_value_type
 
 details::hash_table<perft_value_type> perft_hash_table;
 
+template <perft_generator Generator, bool Bulk, bool Black>
 std::size_t perft_recursive_unmake_hash(bitboard& bb, std::uint64_t& hash, std::size_t depth, std::span<std::uint32_t> move_buf)
 {
+    // Counting the legal moves is cheaper than a hash table probe, so we don't bother storing these nodes.
+    if constexpr (Bulk)
+    {
+        if (depth == 1)
+            return generate_legal_moves<Black>(bb, move_buf);
+    }
+
     if (depth == 0) [[unlikely]]
         return 1;
 
     // Loop up the value in the hash table and return immediately if we hit.
-    auto& entry { perft_hash_table[hash] };
-    if (entry.key == hash && entry.value.depth == depth)
-        return entry.value.nodes;
+    if (perft_value_type entry; perft_hash_table.probe(hash, entry) && entry.depth == depth)
+        return entry.nodes;
 
     std::size_t ret {};
 
-    const std::size_t moves { generate_pseudo_legal_moves(bb, move_buf) };
+    constexpr bool is_legal { Generator == perft_generator::legal };
+    const std::size_t moves { is_legal ? generate_legal_moves<Black>(bb, move_buf) : generate_pseudo_legal_moves<Black>(bb, move_buf) };
     const std::span<std::uint32_t> move_list = move_buf.subspan(0, moves);
 
     for (const auto make : move_list)
     {
         std::uint32_t unmake;
-        if (make_move({ .check_legality = true }, bb, make, unmake, hash)) [[likely]]
-            ret += perft_recursive_unmake_hash(bb, hash, depth-1, move_buf.subspan(moves));
+        if (make_move<Black>({ .check_legality = !is_legal }, bb, make, unmake, hash)) [[likely]]
+            ret += perft_recursive_unmake_hash<Generator, Bulk, !Black>(bb, hash, depth-1, move_buf.subspan(moves));
 
-        unmake_move(bb, make, unmake, hash);
+        unmake_move<Black>(bb, make, unmake, hash);
     }
 
     // Update the hash table with our result - always overriding for now.
-    entry.key = hash;
-    entry.value.depth = depth;
-    entry.value.nodes = ret;
+    perft_hash_table.store(hash, { .depth=depth, .nodes=ret });
 
     return ret;
 }
@@ -82,20 +110,245 @@ std::size_t get_perft_hash_table_bytes()
     return perft_hash_table.get_table_bytes();
 }
 
-std::size_t perft(const bitboard& start, std::size_t depth)
+const details::table_memory& get_perft_hash_table_memory()
 {
-    std::vector<std::uint32_t> move_buf(depth*MAX_MOVES_PER_POSITION);
+    return perft_hash_table.get_table_memory();
+}
 
-    bitboard bb { start };
+namespace
+{
 
+// Counts the nodes below a position (whose hash is only needed if we're using the hash table).
+template <perft_generator Generator, bool Bulk>
+std::size_t perft_position(bitboard& bb, std::uint64_t hash, std::size_t depth, std::span<std::uint32_t> move_buf)
+{
     // Switch implementations depending whether our hash-table is non-empty.
     if (get_perft_hash_table_bytes() == 0)
+        return bb.is_black_to_play() ? perft_recursive_unmake_no_hash<Generator, Bulk, true>(bb, depth, move_buf)
+                                     : perft_recursive_unmake_no_hash<Generator, Bulk, false>(bb, depth, move_buf);
+    else
+        return bb.is_black_to_play() ? perft_recursive_unmake_hash<Generator, Bulk, true>(bb, hash, depth, move_buf)
+                                     : perft_recursive_unmake_hash<Generator, Bulk, false>(bb, hash, depth, move_buf);
+}
+
+std::size_t perft_position(bitboard& bb, std::uint64_t hash, std::size_t depth, const perft_args& args, std::span<std::uint32_t> move_buf)
+{
+    const bool bulk { args.strategy == perft_strategy::bulk_count };
+    if (args.generator == perft_generator::legal)
+        return bulk ? perft_position<perft_generator::legal, true>(bb, hash, depth, move_buf)
+                    : perft_position<perft_generator::legal, false>(bb, hash, depth, move_buf);
+    return bulk ? perft_position<perft_generator::pseudo_legal, true>(bb, hash, depth, move_buf)
+                : perft_position<perft_generator::pseudo_legal, false>(bb, hash, depth, move_buf);
+}
+
+struct perft_split_position
+{
+    bitboard bb;
+    std::uint64_t hash;
+};
+
+// Collects all of the (legal) positions the given number of ply below this one.
+void get_split_positions(bitboard& bb, std::uint64_t& hash, std::size_t ply, perft_generator generator, std::vector<perft_split_position>& positions)
+{
+    if (ply == 0)
     {
-        return perft_recursive_unmake_no_hash(bb, depth, move_buf);
+        positions.push_back({ bb, hash });
+        return;
     }
-    else
+
+    std::array<std::uint32_t, MAX_MOVES_PER_POSITION> move_buf;
+    const bool is_legal { generator == perft_generator::legal };
+    const std::size_t moves { is_legal ? generate_legal_moves(bb, std::span<std::uint32_t>(move_buf)) : generate_pseudo_legal_moves(bb, std::span<std::uint32_t>(move_buf)) };
+
+    for (std::size_t i = 0; i < moves; i++)
+    {
+        std::uint32_t unmake;
+        if (make_move({ .check_legality = !is_legal }, bb, move_buf[i], unmake, hash))
+            get_split_positions(bb, hash, ply-1, generator, positions);
+
+        unmake_move(bb, move_buf[i], unmake, hash);
+    }
+}
+
+}
+
+std::size_t perft(const bitboard& start, std::size_t depth, const perft_args& args)
+{
+    bitboard bb { start };
+    std::uint64_t hash { get_perft_hash_table_bytes() ? zobrist::hash_init(mailbox(bb)) : 0 };
+
+    if (args.threads <= 1 || args.split_ply == 0 || args.split_ply >= depth)
+    {
+        std::vector<std::uint32_t> move_buf(depth*MAX_MOVES_PER_POSITION);
+        return perft_position(bb, hash, depth, args, move_buf);
+    }
+
+    std::vector<perft_split_position> positions;
+    get_split_positions(bb, hash, args.split_ply, args.generator, positions);
+
+    // The threads take the positions in turn until they're all counted, so a thread that gets a small sub-tree just moves on
+    // to the next one.
+    std::atomic<std::size_t> next {};
+    std::atomic<std::size_t> ret {};
+
+    const auto work = [&] ()
+    {
+        std::vector<std::uint32_t> move_buf((depth-args.split_ply)*MAX_MOVES_PER_POSITION);
+
+        std::size_t nodes {};
+        for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < positions.size(); )
+            nodes += perft_position(positions[i].bb, positions[i].hash, depth-args.split_ply, args, move_buf);
+
+        ret.fetch_add(nodes, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < std::min(args.threads, positions.size()); i++)
+        workers.emplace_back(work);
+    for (auto& worker : workers)
+        worker.join();
+
+    return ret;
+}
+
+namespace
+{
+
+// Throws if the incrementally-updated state of a position doesn't match the state calculated from scratch.
+void verify_incremental_state(const bitboard& bb, std::uint64_t hash, const evaluation::piece_square_eval& eval, std::uint32_t make)
+{
+    const auto describe = [&] () { return " after " + move::to_algebraic_long(make) + " into " + bb.get_fen_string(); };
+
+    if (!bb.is_consistent())
+        throw std::logic_error("Inconsistent bitboard" + describe());
+    if (hash != zobrist::hash_init(mailbox(bb)))
+        throw std::logic_error("Incremental hash doesn't match hash_init" + describe());
+    if (!(eval == evaluation::piece_square_eval(bb)))
+        throw std::logic_error("Incremental piece-square evaluation doesn't match a full evaluation" + describe());
+}
+
+std::size_t perft_recursive_verify(bitboard& bb, std::uint64_t& hash, evaluation::piece_square_eval& eval, std::size_t depth, perft_generator generator, std::span<std::uint32_t> move_buf)
+{
+    if (depth == 0)
+        return 1;
+
+    std::size_t ret {};
+
+    const bitboard bb_start { bb };
+    const std::uint64_t hash_start { hash };
+    const evaluation::piece_square_eval eval_start { eval };
+
+    const bool is_legal { generator == perft_generator::legal };
+    const std::size_t moves { is_legal ? generate_legal_moves(bb, move_buf) : generate_pseudo_legal_moves(bb, move_buf) };
+
+    for (std::size_t i = 0; i < moves; i++)
+    {
+        const std::uint32_t make { move_buf[i] };
+
+        std::uint32_t unmake;
+        if (make_move({ .check_legality = !is_legal }, bb, make, unmake, hash, eval))
+        {
+            verify_incremental_state(bb, hash, eval, make);
+            ret += perft_recursive_verify(bb, hash, eval, depth-1, generator, move_buf.subspan(moves));
+        }
+        else if (is_legal)
+            throw std::logic_error("Legal move generator gave illegal move " + move::to_algebraic_long(make) + " in " + bb_start.get_fen_string());
+
+        unmake_move(bb, make, unmake, hash, eval);
+
+        if (bb != bb_start || hash != hash_start || !(eval == eval_start))
+            throw std::logic_error("Unmaking " + move::to_algebraic_long(make) + " didn't restore " + bb_start.get_fen_string());
+    }
+
+    return ret;
+}
+
+}
+
+std::size_t perft_verify(const bitboard& start, std::size_t depth, perft_generator generator)
+{
+    bitboard bb { start };
+    std::uint64_t hash { zobrist::hash_init(mailbox(bb)) };
+    evaluation::piece_square_eval eval(bb);
+
+    std::vector<std::uint32_t> move_buf(std::max<std::size_t>(depth, 1)*MAX_MOVES_PER_POSITION);
+    return perft_recursive_verify(bb, hash, eval, depth, generator, move_buf);
+}
+
+perft_suite_position parse_perft_suite_position(std::string_view line)
+{
+    perft_suite_position ret;
+
+    // The FEN is everything up to the first operation, which might be missing its move counters.
+    const std::size_t fen_end { std::min(line.find(';'), line.size()) };
+    std::istringstream fen_ss(std::string(line.substr(0, fen_end)));
+
+    std::vector<std::string> fields;
+    for (std::string field; fields.size() < 6 && fen_ss >> field; )
+        fields.push_back(std::move(field));
+    if (fields.size() != 4 && fields.size() != 6)
+        throw std::invalid_argument("Incomplete FEN in perft suite position");
+    if (fields.size() == 4)
+        fields.insert(fields.end(), { "0", "1" });
+
+    for (const auto& field : fields)
+        ret.fen += (ret.fen.empty() ? "" : " ") + field;
+
+    // Check the FEN actually parses now, rather than when we get round to running it.
+    [[maybe_unused]] const bitboard bb { ret.fen };
+
+    // The operations are separated by semicolons, and we only want the depths.
+    for (std::size_t pos = fen_end; pos < line.size(); )
+    {
+        const std::size_t end { std::min(line.find(';', pos+1), line.size()) };
+        std::istringstream op_ss(std::string(line.substr(pos+1, end-pos-1)));
+        pos = end;
+
+        std::string opcode;
+        if (!(op_ss >> opcode) || opcode.size() < 2 || opcode[0] != 'D' || !std::all_of(opcode.begin()+1, opcode.end(), [] (char c) { return c >= '0' && c <= '9'; }))
+            continue;
+
+        perft_suite_position::expectation expected { .depth = std::stoull(opcode.substr(1)), .nodes = 0 };
+        if (!(op_ss >> expected.nodes))
+            throw std::invalid_argument("Missing node count for " + opcode + " in perft suite position");
+
+        ret.expected.push_back(expected);
+    }
+
+    if (ret.expected.empty())
+        throw std::invalid_argument("No expected node counts in perft suite position");
+
+    std::sort(ret.expected.begin(), ret.expected.end(), [] (const auto& lhs, const auto& rhs) { return lhs.depth < rhs.depth; });
+
+    return ret;
+}
+
+std::vector<perft_suite_position> load_perft_suite(const std::string& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs)
+        throw std::runtime_error("Unable to open perft suite " + path);
+
+    std::vector<perft_suite_position> ret;
+
+    std::size_t line_number {};
+    for (std::string line; std::getline(ifs, line); )
     {
-        std::uint64_t hash { zobrist::hash_init(mailbox(bb)) };
-        return perft_recursive_unmake_hash(bb, hash, depth, move_buf);
+        line_number++;
+
+        const std::size_t start { line.find_first_not_of(" \t\r") };
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+
+        try
+        {
+            ret.push_back(parse_perft_suite_position(line));
+        }
+        catch (const std::exception& e)
+        {
+            throw std::invalid_argument(path + ":" + std::to_string(line_number) + ": " + e.what());
+        }
     }
+
+    return ret;
 }
@@ -1,9 +1,72 @@
 #pragma once
 
 #include "position/bitboard.hpp"
+#include "details/table_memory.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
 
 // Note only allocates the log2_floor the entries.
 void set_perft_hash_table_bytes(std::size_t bytes);
 std::size_t get_perft_hash_table_bytes();
+const details::table_memory& get_perft_hash_table_memory();
+
+// Which move generator perft walks the tree with - pseudo-legal moves with the illegal ones filtered out by make-move, or
+// the legal move generator.
+enum class perft_generator
+{
+    pseudo_legal,
+    legal
+};
+
+// How the leaves of the tree are counted - by making and unmaking every move at the last ply, or by just counting the legal
+// moves at the ply above (bulk-counting), which leaves out the cost of make/unmake at the leaves and so mostly measures the
+// move generator. Bulk-counting always uses the legal move generator at the last ply, whichever generator walks the rest of
+// the tree.
+enum class perft_strategy
+{
+    make_unmake,
+    bulk_count
+};
+
+// Perft can be run across several threads, by splitting the tree at the given ply - each position at that ply (the position
+// after each root move with the default of 1) is counted by whichever thread gets to it next. The hash table is lock-free, so
+// the threads share it, and can pick up each other's results for transpositions.
+struct perft_args
+{
+    perft_generator generator { perft_generator::pseudo_legal };
+    perft_strategy strategy   { perft_strategy::make_unmake };
+    std::size_t threads       { 1 };
+    std::size_t split_ply     { 1 };
+};
+
+std::size_t perft(const bitboard& start, std::size_t depth, const perft_args& args = {});
+
+// Walks the tree like perft (with make/unmake and without the hash table), but also checks at every node that the
+// incrementally-updated hash and piece-square evaluation agree with ones calculated from scratch, and that unmaking each
+// move restores everything. Throws (a std::logic_error) describing the first disagreement.
+std::size_t perft_verify(const bitboard& start, std::size_t depth, perft_generator generator = perft_generator::pseudo_legal);
+
+// A position of a perft suite along with its expected node counts at one or more depths.
+struct perft_suite_position
+{
+    struct expectation
+    {
+        std::size_t depth;
+        std::size_t nodes;
+    };
+
+    std::string fen;
+    std::vector<expectation> expected;
+};
+
+// Parses a perft suite position in the usual EPD format, with the expected node counts as D<depth> operations:
+//     <fen> ;D1 20 ;D2 400 ;D3 8902
+// The move counters are optional, and any other operations are ignored. Throws (a std::invalid_argument) if the line can't
+// be parsed or doesn't have any expected node counts.
+perft_suite_position parse_perft_suite_position(std::string_view line);
 
-std::size_t perft(const bitboard& start, std::size_t depth);
\ No newline at end of file
+// Loads a perft suite from a file with a position per line, skipping empty lines and comments (starting with #). Throws if
+// the file can't be read or any of its lines can't be parsed.
+std::vector<perft_suite_position> load_perft_suite(const std::string& path);
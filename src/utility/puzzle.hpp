@@ -2,6 +2,8 @@
 
 #include "position/game_state.hpp"
 
+#include <vector>
+
 struct solver
 {
     struct puzzle;
@@ -112,10 +112,8 @@ void command_setoption::read(std::istream& is)
     value.emplace();
 
     // Parse the option value if necessary.
-    while (is)
+    while (is >> token)
     {
-        is >> token;
-
         if (!value->empty())
             value->push_back(' ');
         value->append(token);
@@ -107,10 +107,10 @@ struct command_go : command
 
     std::vector<std::string> searchmoves;
 
-    bool ponder;
+    bool ponder {};
 
     std::optional<std::size_t> wtime, btime, winc, binc, movestogo, movetime;
-    bool infinite;
+    bool infinite {};
 
     // Returns 0 if the increment isn't set.
     std::size_t get_increment_ms(bool is_black) const noexcept;
@@ -0,0 +1,288 @@
+#include "details/hash_table.hpp"
+#include "details/transposition_table.hpp"
+#include "evaluation/evaluate.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// A wide value where every word is derived from the key, so we can tell if a probe returned a mixture of two different writes.
+struct stress_value_type
+{
+    std::array<std::uint64_t, 4> words;
+
+    static stress_value_type from_key(std::uint64_t key) noexcept
+    {
+        stress_value_type ret;
+        for (std::size_t i = 0; i < ret.words.size(); i++)
+            ret.words[i] = key * (0x9e3779b97f4a7c15ULL + 2*i);
+        return ret;
+    }
+
+    friend bool operator==(const stress_value_type&, const stress_value_type&) = default;
+};
+
+std::uint64_t xorshift(std::uint64_t& state) noexcept
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+}
+
+TEST(HashTable, ProbeStore)
+{
+    struct value_type
+    {
+        std::size_t depth;
+        std::size_t nodes;
+    };
+
+    details::hash_table<value_type> table;
+    table.set_table_entries(1024);
+    ASSERT_EQ(table.get_table_entries(), 1024);
+
+    const std::uint64_t key { 0xdeadbeefcafe0001ULL };
+
+    value_type probed;
+    ASSERT_FALSE(table.probe(key, probed));
+
+    table.store(key, { .depth=5, .nodes=4865609 });
+    ASSERT_TRUE(table.probe(key, probed));
+    ASSERT_EQ(probed.depth, 5);
+    ASSERT_EQ(probed.nodes, 4865609);
+
+    // A different key mapping to the same slot must miss.
+    ASSERT_FALSE(table.probe(key ^ (1ULL << 40), probed));
+}
+
+TEST(TranspositionTable, ProbeStore)
+{
+    details::transposition_table table;
+    table.set_table_bytes(1 << 20);
+    ASSERT_EQ(table.get_table_bytes(), 1 << 20);
+    ASSERT_EQ(table.get_table_entries(), (1 << 20)/sizeof(details::transposition_table::entry_type));
+
+    const details::search_value_type value { .age=3, .depth=7, .eval=-42, .best_move=0x01234567, .meta=2 };
+    const std::uint64_t key { 0xdeadbeefcafe0001ULL };
+
+    details::search_value_type probed;
+    ASSERT_FALSE(table.probe(key, probed));
+
+    table.store(key, value);
+    ASSERT_TRUE(table.probe(key, probed));
+    ASSERT_EQ(probed.age, value.age);
+    ASSERT_EQ(probed.depth, value.depth);
+    ASSERT_EQ(probed.eval, value.eval);
+    ASSERT_EQ(probed.best_move, value.best_move);
+    ASSERT_EQ(probed.meta, value.meta);
+
+    // Checkmate scores must survive the packing, while other evaluations too big for it are saturated.
+    for (const int eval : { evaluation::EVAL_CHECKMATE, -evaluation::EVAL_CHECKMATE })
+    {
+        table.store(key, { .age=3, .depth=7, .eval=eval, .best_move=0, .meta=0 });
+        ASSERT_TRUE(table.probe(key, probed));
+        ASSERT_EQ(probed.eval, eval);
+    }
+    table.store(key, { .age=3, .depth=7, .eval=1000000, .best_move=0, .meta=0 });
+    ASSERT_TRUE(table.probe(key, probed));
+    ASSERT_GT(probed.eval, 30000);
+    ASSERT_LT(probed.eval, evaluation::EVAL_CHECKMATE);
+
+    // A different key mapping to the same bucket must miss.
+    ASSERT_FALSE(table.probe(key ^ (1ULL << 40), probed));
+}
+
+TEST(TranspositionTable, Replacement)
+{
+    details::transposition_table table;
+    table.set_table_entries(2*details::transposition_table::BUCKET_ENTRIES);
+
+    // All of our keys land in the first bucket. Fill it with entries of decreasing depth from the current search.
+    constexpr std::uint8_t age { 10 };
+    const auto make_key = [] (std::uint64_t i) { return (i+1) << 32; };
+    for (std::uint64_t i = 0; i < details::transposition_table::BUCKET_ENTRIES; i++)
+        table.store(make_key(i), { .age=age, .depth=static_cast<std::uint8_t>(20-i), .eval=0, .best_move=0, .meta=0 });
+
+    // A new entry should evict the shallowest.
+    details::search_value_type probed;
+    table.store(make_key(100), { .age=age, .depth=1, .eval=0, .best_move=0, .meta=0 });
+    ASSERT_TRUE(table.probe(make_key(100), probed));
+    ASSERT_FALSE(table.probe(make_key(details::transposition_table::BUCKET_ENTRIES-1), probed));
+    for (std::uint64_t i = 0; i+1 < details::transposition_table::BUCKET_ENTRIES; i++)
+        ASSERT_TRUE(table.probe(make_key(i), probed));
+
+    // Entries from an old search are evicted before deep entries from the current one.
+    table.store(make_key(0), { .age=age-3, .depth=20, .eval=0, .best_move=0, .meta=0 });
+    table.store(make_key(101), { .age=age, .depth=1, .eval=0, .best_move=0, .meta=0 });
+    ASSERT_FALSE(table.probe(make_key(0), probed));
+    ASSERT_TRUE(table.probe(make_key(101), probed));
+
+    // Storing an existing key overwrites it in-place.
+    table.store(make_key(1), { .age=age, .depth=0, .eval=123, .best_move=0, .meta=0 });
+    ASSERT_TRUE(table.probe(make_key(1), probed));
+    ASSERT_EQ(probed.eval, 123);
+    ASSERT_TRUE(table.probe(make_key(101), probed));
+}
+
+// Hammers a tiny table from many threads, so that the same entries are constantly being written concurrently, and checks that
+// a successful probe never returns an entry made up of words from different writes.
+TEST(HashTable, ConcurrentStress)
+{
+    constexpr std::size_t threads    { 8 };
+    constexpr std::size_t iterations { 1 << 20 };
+
+    details::hash_table<stress_value_type> table;
+    table.set_table_entries(16);
+
+    std::atomic<std::size_t> hits {};
+    std::atomic<std::size_t> torn {};
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&table, &hits, &torn, t] ()
+        {
+            std::uint64_t state { 0x2545f4914f6cdd1dULL + t };
+            std::size_t hits_local {};
+            std::size_t torn_local {};
+
+            for (std::size_t i = 0; i < iterations; i++)
+            {
+                // Use a small pool of keys so that probes regularly find something.
+                const std::uint64_t key { (xorshift(state) & 0xff) * 0x100000001b3ULL + 1 };
+                if (i & 1)
+                {
+                    table.store(key, stress_value_type::from_key(key));
+                }
+                else if (stress_value_type value; table.probe(key, value))
+                {
+                    hits_local++;
+                    if (value != stress_value_type::from_key(key))
+                        torn_local++;
+                }
+            }
+
+            hits += hits_local;
+            torn += torn_local;
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    ASSERT_GT(hits.load(), 0);
+    ASSERT_EQ(torn.load(), 0);
+}
+
+// As above, but for the bucketed transposition table. Every thread writes its own evaluation and depth for each key (with the
+// same move and meta), so a probe has to return exactly what one of the threads wrote.
+TEST(TranspositionTable, ConcurrentStress)
+{
+    constexpr std::size_t threads    { 8 };
+    constexpr std::size_t iterations { 1 << 20 };
+
+    details::transposition_table table;
+    table.set_table_entries(4*details::transposition_table::BUCKET_ENTRIES);
+
+    const auto from_key = [] (std::uint64_t key, std::size_t t) -> details::search_value_type
+    {
+        const std::uint32_t k { static_cast<std::uint32_t>(key >> 32) };
+        const int eval { static_cast<int>(k % 1000) + static_cast<int>(t) };
+        return { .age=static_cast<std::uint8_t>(k + t), .depth=static_cast<std::uint8_t>((k >> 8) + 37*t), .eval=(t & 1) ? -eval : eval,
+                 .best_move=k & 0x0fffffff, .meta=static_cast<std::uint8_t>(k & 3) };
+    };
+
+    std::atomic<std::size_t> hits {};
+    std::atomic<std::size_t> torn {};
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&table, &hits, &torn, &from_key, t] ()
+        {
+            std::uint64_t state { 0x2545f4914f6cdd1dULL + t };
+            std::size_t hits_local {};
+            std::size_t torn_local {};
+
+            for (std::size_t i = 0; i < iterations; i++)
+            {
+                const std::uint64_t key { ((xorshift(state) & 0xff) * 0x100000001b3ULL + 1) << 16 };
+                if (i & 1)
+                {
+                    table.store(key, from_key(key, t));
+                }
+                else if (details::search_value_type value; table.probe(key, value))
+                {
+                    hits_local++;
+                    bool written { false };
+                    for (std::size_t w = 0; w < threads && !written; w++)
+                    {
+                        const auto expected { from_key(key, w) };
+                        written = value.age == expected.age && value.depth == expected.depth && value.eval == expected.eval &&
+                                  value.best_move == expected.best_move && value.meta == expected.meta;
+                    }
+                    if (!written)
+                        torn_local++;
+                }
+            }
+
+            hits += hits_local;
+            torn += torn_local;
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    ASSERT_GT(hits.load(), 0);
+    ASSERT_EQ(torn.load(), 0);
+}
+
+#ifdef __linux__
+// Allocating a table of normal pages whose size isn't a whole number of pages mustn't leave any of its mapping behind when
+// it's freed - we check that repeatedly doing so doesn't grow our address space.
+TEST(TableMemory, NoLeakedMappings)
+{
+    const auto get_vm_size_kb = [] () -> std::size_t
+    {
+        std::ifstream is("/proc/self/status");
+        for (std::string line; std::getline(is, line); )
+            if (line.starts_with("VmSize:"))
+                return std::stoull(line.substr(7));
+        return 0;
+    };
+
+    const details::page_type page_type { details::get_page_type() };
+    details::set_page_type(details::page_type::normal);
+
+    { details::table_memory memory(1000001); }
+    const std::size_t vm_size_kb { get_vm_size_kb() };
+    ASSERT_GT(vm_size_kb, 0);
+
+    for (std::size_t i = 0; i < 64; i++)
+        details::table_memory memory(1000001 + 4096*i + 123);
+
+    // Each leak would be most of a huge page, so a few pages of slack is plenty.
+    EXPECT_LT(get_vm_size_kb(), vm_size_kb + 64);
+
+    details::set_page_type(page_type);
+}
+#endif
+
+// Tests the correctness of the lock-free hash tables, including under concurrent access.
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
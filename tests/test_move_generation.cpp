@@ -1,5 +1,6 @@
 #include "evaluation/evaluate.hpp"
 #include "pieces/pieces.hpp"
+#include "position/attacks.hpp"
 #include "position/generate_moves.hpp"
 #include "position/make_move.hpp"
 #include "position/move.hpp"
@@ -8,6 +9,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 namespace
 {
 
@@ -28,13 +33,31 @@ void test_move_generation_recursive(const bitboard& bb, const std::uint64_t hash
     std::size_t moves { generate_pseudo_legal_moves(bb, std::span<std::uint32_t>(move_buf)) };
     move_buf[moves++] = move::NULL_MOVE;
 
+    const check_info ci { get_check_info(bb) };
+
+    // The pseudo-legal moves that turn out to be legal when made.
+    std::vector<std::uint32_t> legal_buf;
+
     for (std::size_t i = 0; i < moves; i++)
     {
         const std::uint32_t make = move_buf[i];
 
         std::uint32_t unmake;
         if (make_move({ .check_legality = true }, bb_copy, make, unmake, hash_copy, eval_copy))
+        {
+            if (make != move::NULL_MOVE)
+                legal_buf.push_back(make);
+
+            ASSERT_TRUE(bb_copy.is_consistent()) << move::to_algebraic_long(make) << " in " << bb.get_fen_string();
+
+            // Working out whether the move gives check without making it should agree with actually making it.
+            if (make != move::NULL_MOVE)
+            {
+                EXPECT_EQ(gives_check(bb, ci, make), is_in_check(bb_copy)) << move::to_algebraic_long(make) << " in " << bb.get_fen_string();
+            }
+
             test_move_generation_recursive(bb_copy, hash_copy, eval_copy, depth-1);
+        }
 
         unmake_move(bb_copy, make, unmake, hash_copy, eval_copy);
 
@@ -44,6 +67,13 @@ void test_move_generation_recursive(const bitboard& bb, const std::uint64_t hash
         EXPECT_EQ(eval, eval_copy);
         EXPECT_EQ(eval, evaluation::piece_square_eval(bb_copy));
     }
+
+    // The legal move generator should give exactly the same moves.
+    std::vector<std::uint32_t> generated_buf(MAX_MOVES_PER_POSITION);
+    generated_buf.resize(generate_legal_moves(bb, std::span<std::uint32_t>(generated_buf)));
+    std::sort(legal_buf.begin(), legal_buf.end());
+    std::sort(generated_buf.begin(), generated_buf.end());
+    ASSERT_EQ(legal_buf, generated_buf) << bb.get_fen_string();
 }
 
 void test_move_generation(const char* fen, std::size_t depth)
@@ -54,6 +84,78 @@ void test_move_generation(const char* fen, std::size_t depth)
     test_move_generation_recursive(bb, hash, eval, depth);
 }
 
+// Checks is_pseudo_legal against the generated move-list for every possible move encoding (for the pieces of the side to
+// move) in this position and its children.
+void test_pseudo_legality_recursive(bitboard& bb, std::size_t depth)
+{
+    std::vector<std::uint32_t> move_buf(MAX_MOVES_PER_POSITION);
+    const std::size_t moves { generate_pseudo_legal_moves(bb, std::span<std::uint32_t>(move_buf)) };
+    move_buf.resize(moves);
+    std::sort(move_buf.begin(), move_buf.end());
+
+    // The loud and quiet moves should exactly split up all of the moves.
+    std::vector<std::uint32_t> split_buf(MAX_MOVES_PER_POSITION);
+    std::size_t split_moves { generate_pseudo_legal_loud_moves(bb, std::span<std::uint32_t>(split_buf)) };
+    split_moves += generate_pseudo_legal_quiet_moves(bb, std::span<std::uint32_t>(split_buf).subspan(split_moves));
+    split_buf.resize(split_moves);
+    std::sort(split_buf.begin(), split_buf.end());
+    ASSERT_EQ(move_buf, split_buf) << bb.get_fen_string();
+
+    // Any info bits on the move shouldn't make a difference.
+    for (const std::uint32_t move : move_buf)
+        ASSERT_TRUE(is_pseudo_legal(bb, move | move::info::CHECK | move::info::HASH)) << move::to_algebraic_long(move);
+
+    constexpr std::array<std::uint32_t, 9> types {
+        0,
+        move::type::CAPTURE,
+        move::type::CAPTURE | move::type::EN_PASSENT,
+        move::type::CAPTURE | move::type::PROMOTION,
+        move::type::PAWN_PUSH_SINGLE,
+        move::type::PAWN_PUSH_SINGLE | move::type::PROMOTION,
+        move::type::PAWN_PUSH_DOUBLE,
+        move::type::CASTLE_KS,
+        move::type::CASTLE_QS
+    };
+
+    const bool is_black { bb.is_black_to_play() };
+    for (std::size_t piece = piece_idx::w_pawn; piece <= piece_idx::w_queen; piece++)
+    {
+        const piece_idx p { set_piece_colour(static_cast<piece_idx>(piece), is_black) };
+        for (std::size_t from = 0; from < 64; from++)
+        {
+            for (std::size_t to = 0; to < 64; to++)
+            {
+                for (const std::uint32_t type : types)
+                {
+                    for (std::size_t promotion = 0; promotion < ((type & move::type::PROMOTION) ? 16 : 1); promotion++)
+                    {
+                        const std::uint32_t move { move::make_encode(from, to, p, static_cast<piece_idx>(promotion)) | type };
+                        const bool generated { std::binary_search(move_buf.begin(), move_buf.end(), move) };
+                        ASSERT_EQ(generated, is_pseudo_legal(bb, move)) << move::to_algebraic_long(move) << " in " << bb.get_fen_string();
+                    }
+                }
+            }
+        }
+    }
+
+    if (depth == 0)
+        return;
+
+    for (const std::uint32_t make : std::vector<std::uint32_t>(move_buf))
+    {
+        std::uint32_t unmake;
+        if (make_move({ .check_legality = true }, bb, make, unmake))
+            test_pseudo_legality_recursive(bb, depth-1);
+        unmake_move(bb, make, unmake);
+    }
+}
+
+void test_pseudo_legality(const char* fen, std::size_t depth)
+{
+    bitboard bb { fen };
+    test_pseudo_legality_recursive(bb, depth);
+}
+
 }
 
 TEST(MoveGeneration, StartingPosition)
@@ -81,6 +183,30 @@ TEST(MoveGeneration, Pos6)
     test_move_generation(POS6_FEN, 4);
 }
 
+// Positions with awkward pins and checks for the legal move generator - en-passent captures that expose the king along the
+// rank or a diagonal, or that get out of check, pawns pinned along every direction, and double-checks.
+TEST(MoveGeneration, LegalMoves)
+{
+    for (const char* fen : {
+        "8/8/8/KPp4r/8/8/8/7k w - c6 0 2",
+        "8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1",
+        "8/8/8/2k5/3Pp3/8/8/4K2B b - d3 0 1",
+        "8/8/8/3pP3/4K3/8/8/7k w - d6 0 2",
+        "8/8/8/2k5/3Pp3/8/8/3K4 b - d3 0 1",
+        "4k3/4r3/8/8/4P2b/8/5P2/4K3 w - - 0 1",
+        "4k3/8/8/1b6/8/8/4r3/R3K2R w KQ - 0 1",
+        "r3k2r/8/8/8/4N3/8/5q2/R3K2R w KQkq - 0 1",
+        "3k4/8/8/8/8/8/3PPP2/r2QK2r w - - 0 1",
+        "4k3/8/8/8/8/5n2/8/r3K3 w - - 0 1" })
+        test_move_generation(fen, 3);
+}
+
+TEST(MoveGeneration, PseudoLegality)
+{
+    for (const char* fen : { STARTING_FEN, KIWIPETE_FEN, POS3_FEN, POS4_FEN, POS5_FEN, POS6_FEN, BEHTING_FEN, HANSSECELLE_FEN })
+        test_pseudo_legality(fen, 1);
+}
+
 // Tests the correctness of make / unmake / zobrist hashing in a non-performant
 // way across a variety of positions.
 int main(int argc, char **argv)
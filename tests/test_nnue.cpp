@@ -0,0 +1,209 @@
+#include "evaluation/nnue.hpp"
+#include "position/bitboard.hpp"
+#include "position/game_state.hpp"
+#include "position/generate_moves.hpp"
+#include "position/make_move.hpp"
+
+#include "test_positions.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+namespace nnue = evaluation::nnue;
+
+namespace
+{
+
+// A network with random (but small enough to never overflow the accumulators) weights.
+std::shared_ptr<nnue::network> make_random_network(std::uint32_t seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> feature_dist(-64, 64);
+    std::uniform_int_distribution<int> output_dist(-128, 128);
+
+    auto net { std::make_shared<nnue::network>() };
+    for (auto& row : net->feature_weights)
+        for (auto& w : row)
+            w = static_cast<std::int16_t>(feature_dist(gen));
+    for (auto& w : net->feature_bias)
+        w = static_cast<std::int16_t>(feature_dist(gen) + nnue::QA/2);
+    for (auto& w : net->output_weights)
+        w = static_cast<std::int16_t>(output_dist(gen));
+    net->output_bias = output_dist(gen) * nnue::QA;
+
+    return net;
+}
+
+// Checks the SIMD kernels against the scalar ones on random data, including accumulator values outside of the clipped range.
+template<typename Kernels>
+void test_kernels(std::uint32_t seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+
+    const auto net { make_random_network(seed) };
+    for (std::size_t i = 0; i < 100; i++)
+    {
+        nnue::accumulator acc;
+        for (auto& values : acc.values)
+            for (auto& v : values)
+                v = static_cast<std::int16_t>(dist(gen));
+
+        // Output layer.
+        const auto simd_output   { Kernels::output(acc.values[0], acc.values[1], net->output_weights) };
+        const auto scalar_output { nnue::details::kernels_scalar::output(acc.values[0], acc.values[1], net->output_weights) };
+        ASSERT_EQ(simd_output, scalar_output);
+
+        // Accumulator updates with up to two features added and removed.
+        const std::array<const std::int16_t*, 2> adds { net->feature_weights[gen() % nnue::INPUTS].data(), net->feature_weights[gen() % nnue::INPUTS].data() };
+        const std::array<const std::int16_t*, 2> subs { net->feature_weights[gen() % nnue::INPUTS].data(), net->feature_weights[gen() % nnue::INPUTS].data() };
+        const std::size_t adds_size { i % 3 };
+        const std::size_t subs_size { (i / 3) % 3 };
+
+        nnue::accumulator simd_acc { acc };
+        nnue::accumulator scalar_acc { acc };
+        Kernels::update(simd_acc.values[0], { adds.data(), adds_size }, { subs.data(), subs_size });
+        nnue::details::kernels_scalar::update(scalar_acc.values[0], { adds.data(), adds_size }, { subs.data(), subs_size });
+        ASSERT_EQ(simd_acc, scalar_acc);
+    }
+}
+
+// Checks the incrementally-updated accumulators against refreshing them from scratch, as well as the output of whichever
+// kernels we are using against the scalar output.
+void test_accumulator_recursive(game_state& gs, std::size_t depth)
+{
+    nnue::accumulator refreshed;
+    nnue::refresh(refreshed, *gs.nnue, gs.bb);
+    ASSERT_EQ(gs.nnue_accumulator, refreshed) << gs.bb.get_fen_string();
+
+    const bool is_black_to_play { gs.bb.is_black_to_play() };
+    const auto& acc { gs.nnue_accumulator };
+    ASSERT_EQ(nnue::details::kernels::output(acc.values[is_black_to_play], acc.values[!is_black_to_play], gs.nnue->output_weights),
+              nnue::details::kernels_scalar::output(acc.values[is_black_to_play], acc.values[!is_black_to_play], gs.nnue->output_weights))
+        << gs.bb.get_fen_string();
+
+    if (depth == 0)
+        return;
+
+    std::array<std::uint32_t, MAX_MOVES_PER_POSITION> move_buf;
+    const std::size_t moves { generate_pseudo_legal_moves(gs.bb, std::span<std::uint32_t>(move_buf)) };
+    for (std::size_t i = 0; i < moves; i++)
+    {
+        std::uint32_t unmake;
+        if (make_move({ .check_legality = true }, gs, move_buf[i], unmake))
+            test_accumulator_recursive(gs, depth-1);
+        unmake_move(gs, move_buf[i], unmake);
+    }
+
+    // Null moves shouldn't touch the accumulators.
+    std::uint32_t unmake;
+    make_move({}, gs, move::NULL_MOVE, unmake);
+    ASSERT_EQ(gs.nnue_accumulator, refreshed);
+    unmake_move(gs, move::NULL_MOVE, unmake);
+}
+
+void test_accumulator(const char* fen, std::size_t depth)
+{
+    game_state gs;
+    gs.reset();
+    gs.load(bitboard(fen));
+    gs.set_nnue(make_random_network(1));
+    test_accumulator_recursive(gs, depth);
+}
+
+}
+
+TEST(NNUE, FeatureIdx)
+{
+    // Each side sees its own pieces first, with black's view of the board flipped.
+    ASSERT_EQ(nnue::get_feature_idx(piece_idx::w_pawn,  0,  false), 0);
+    ASSERT_EQ(nnue::get_feature_idx(piece_idx::w_pawn,  0,  true),  384 + 56);
+    ASSERT_EQ(nnue::get_feature_idx(piece_idx::b_pawn,  56, true),  0);
+    ASSERT_EQ(nnue::get_feature_idx(piece_idx::b_queen, 63, false), 384 + 5*64 + 63);
+    ASSERT_EQ(nnue::get_feature_idx(piece_idx::b_queen, 63, true),  5*64 + 7);
+}
+
+TEST(NNUE, KernelsScalar)
+{
+    test_kernels<nnue::details::kernels_scalar>(1);
+}
+
+#ifdef __AVX2__
+TEST(NNUE, KernelsAVX2)
+{
+    test_kernels<nnue::details::kernels_avx2>(2);
+}
+#endif
+
+#ifdef __AVX512BW__
+TEST(NNUE, KernelsAVX512)
+{
+    test_kernels<nnue::details::kernels_avx512>(3);
+}
+#endif
+
+TEST(NNUE, IncrementalAccumulator)
+{
+    // These between them cover castling, en-passent, promotions (with and without capture), and plenty of captures.
+    test_accumulator(STARTING_FEN, 3);
+    test_accumulator(KIWIPETE_FEN, 3);
+    test_accumulator(POS3_FEN,     4);
+    test_accumulator(POS4_FEN,     3);
+    test_accumulator(POS5_FEN,     3);
+}
+
+TEST(NNUE, Symmetry)
+{
+    // The network only sees the position from the side-to-play's perspective, so a colour-flipped position scores the same.
+    game_state white_gs;
+    white_gs.reset();
+    white_gs.load(bitboard("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+    white_gs.set_nnue(make_random_network(1));
+
+    game_state black_gs;
+    black_gs.reset();
+    black_gs.load(bitboard("r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 1"));
+    black_gs.set_nnue(make_random_network(1));
+
+    ASSERT_EQ(white_gs.evaluate(), -black_gs.evaluate());
+}
+
+TEST(NNUE, Load)
+{
+    const auto net { make_random_network(1) };
+    const auto path { std::filesystem::temp_directory_path() / "waychess-test-nnue.bin" };
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(net->feature_weights.data()), sizeof(net->feature_weights));
+        ofs.write(reinterpret_cast<const char*>(net->feature_bias.data()),    sizeof(net->feature_bias));
+        ofs.write(reinterpret_cast<const char*>(net->output_weights.data()),  sizeof(net->output_weights));
+        ofs.write(reinterpret_cast<const char*>(&net->output_bias),           sizeof(net->output_bias));
+    }
+
+    const auto loaded { nnue::network::load(path) };
+    ASSERT_EQ(loaded->feature_weights, net->feature_weights);
+    ASSERT_EQ(loaded->feature_bias,    net->feature_bias);
+    ASSERT_EQ(loaded->output_weights,  net->output_weights);
+    ASSERT_EQ(loaded->output_bias,     net->output_bias);
+
+    // A truncated file is rejected.
+    std::filesystem::resize_file(path, nnue::network::FILE_BYTES - 1);
+    ASSERT_THROW(nnue::network::load(path), std::runtime_error);
+    std::filesystem::remove(path);
+
+    ASSERT_THROW(nnue::network::load(path), std::runtime_error);
+}
+
+// Test correctness of the NNUE evaluation.
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
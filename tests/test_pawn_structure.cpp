@@ -1,11 +1,65 @@
 #include "pieces/pieces.hpp"
 #include "position/bitboard.hpp"
+#include "position/game_state.hpp"
+#include "position/generate_moves.hpp"
+#include "position/mailbox.hpp"
+#include "position/make_move.hpp"
+#include "position/zobrist_hash.hpp"
 #include "evaluation/evaluate_king_safety.hpp"
+#include "evaluation/evaluate_pawn_structure.hpp"
 
 #include "test_positions.hpp"
 
 #include <gtest/gtest.h>
 
+#include <array>
+
+namespace
+{
+
+// Checks the incrementally-updated pawn hash against hashing the pawns from scratch, and that the pawn hash table gives back
+// the same pawn-structure evaluation as calculating it directly.
+void test_pawn_hash_recursive(game_state& gs, std::size_t depth)
+{
+    ASSERT_EQ(gs.pawn_hash, zobrist::pawn_hash_init(mailbox(gs.bb))) << gs.bb.get_fen_string();
+
+    // Evaluate twice so that the second one is (almost certainly) from the table.
+    for (std::size_t i = 0; i < 2; i++)
+    {
+        gs.evaluate();
+
+        evaluation::phased_eval cached;
+        ASSERT_TRUE(gs.pawn_hash_table->probe(gs.pawn_hash, cached));
+
+        const evaluation::phased_eval direct { evaluation::evaluate_pawn_structure_pawns(gs.bb) };
+        ASSERT_EQ(cached.mg, direct.mg) << gs.bb.get_fen_string();
+        ASSERT_EQ(cached.eg, direct.eg) << gs.bb.get_fen_string();
+    }
+
+    if (depth == 0)
+        return;
+
+    std::array<std::uint32_t, MAX_MOVES_PER_POSITION> move_buf;
+    const std::size_t moves { generate_pseudo_legal_moves(gs.bb, std::span<std::uint32_t>(move_buf)) };
+    for (std::size_t i = 0; i < moves; i++)
+    {
+        std::uint32_t unmake;
+        if (make_move({ .check_legality = true }, gs, move_buf[i], unmake))
+            test_pawn_hash_recursive(gs, depth-1);
+        unmake_move(gs, move_buf[i], unmake);
+    }
+}
+
+void test_pawn_hash(const char* fen, std::size_t depth)
+{
+    game_state gs;
+    gs.reset();
+    gs.load(bitboard(fen));
+    test_pawn_hash_recursive(gs, depth);
+}
+
+}
+
 TEST(PawnStructure, StartingPosition)
 {
     const bitboard bb(STARTING_FEN);
@@ -182,6 +236,16 @@ TEST(PawnStructure, HansSecelle)
     ASSERT_EQ(evaluation::get_black_pawn_shield(bb), 0);
 }
 
+TEST(PawnStructure, PawnHash)
+{
+    // These between them cover en-passent, promotions (with and without capture), and captures of and by pawns.
+    test_pawn_hash(STARTING_FEN, 3);
+    test_pawn_hash(KIWIPETE_FEN, 3);
+    test_pawn_hash(POS3_FEN,     4);
+    test_pawn_hash(POS4_FEN,     3);
+    test_pawn_hash(POS5_FEN,     3);
+}
+
 // Test correctness of pawn-structure assessment.
 int main(int argc, char **argv)
 {
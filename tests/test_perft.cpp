@@ -4,6 +4,8 @@
 
 #include <gtest/gtest.h>
 
+#include <stdexcept>
+
 TEST(Perft, StartingPosition)
 {
     std::vector<std::size_t> results {
@@ -101,6 +103,88 @@ TEST(Perft, Pos6)
         EXPECT_EQ(perft(bitboard(POS6_FEN), i), results[i]);
 }
 
+// The legal move generator should give the same results. We walk the trees without the hash table, so that we aren't just
+// reading back the results of the tests above.
+TEST(Perft, LegalGenerator)
+{
+    const std::size_t hash_table_bytes { get_perft_hash_table_bytes() };
+    set_perft_hash_table_bytes(0);
+
+    EXPECT_EQ(perft(bitboard(STARTING_FEN), 5, { .generator=perft_generator::legal }), 4865609);
+    EXPECT_EQ(perft(bitboard(KIWIPETE_FEN), 4, { .generator=perft_generator::legal }), 4085603);
+    EXPECT_EQ(perft(bitboard(POS3_FEN),     6, { .generator=perft_generator::legal }), 11030083);
+    EXPECT_EQ(perft(bitboard(POS4_FEN),     5, { .generator=perft_generator::legal }), 15833292);
+    EXPECT_EQ(perft(bitboard(POS5_FEN),     4, { .generator=perft_generator::legal }), 2103487);
+    EXPECT_EQ(perft(bitboard(POS6_FEN),     4, { .generator=perft_generator::legal }), 3894594);
+
+    set_perft_hash_table_bytes(hash_table_bytes);
+}
+
+// Splitting the tree between threads should give the same results, both with the (shared) hash table and without.
+TEST(Perft, Threaded)
+{
+    EXPECT_EQ(perft(bitboard(KIWIPETE_FEN), 4, { .generator=perft_generator::pseudo_legal, .threads=4 }), 4085603);
+    EXPECT_EQ(perft(bitboard(POS3_FEN),     6, { .generator=perft_generator::pseudo_legal, .threads=4, .split_ply=2 }), 11030083);
+    EXPECT_EQ(perft(bitboard(POS4_FEN),     5, { .generator=perft_generator::legal,        .threads=3, .split_ply=3 }), 15833292);
+
+    const std::size_t hash_table_bytes { get_perft_hash_table_bytes() };
+    set_perft_hash_table_bytes(0);
+
+    EXPECT_EQ(perft(bitboard(STARTING_FEN), 5, { .generator=perft_generator::pseudo_legal, .threads=4 }), 4865609);
+    EXPECT_EQ(perft(bitboard(POS5_FEN),     4, { .generator=perft_generator::legal,        .threads=4, .split_ply=2 }), 2103487);
+    EXPECT_EQ(perft(bitboard(POS6_FEN),     4, { .generator=perft_generator::pseudo_legal, .threads=2, .split_ply=5 }), 3894594);
+
+    set_perft_hash_table_bytes(hash_table_bytes);
+}
+
+// Bulk-counting the leaves should give the same results with either generator walking the rest of the tree, and the hash
+// table shouldn't mind that the nodes at the last ply are never stored.
+TEST(Perft, BulkCount)
+{
+    EXPECT_EQ(perft(bitboard(STARTING_FEN), 1, { .strategy=perft_strategy::bulk_count }), 20);
+    EXPECT_EQ(perft(bitboard(KIWIPETE_FEN), 4, { .generator=perft_generator::legal, .strategy=perft_strategy::bulk_count }), 4085603);
+    EXPECT_EQ(perft(bitboard(POS3_FEN),     6, { .generator=perft_generator::pseudo_legal, .strategy=perft_strategy::bulk_count, .threads=4, .split_ply=2 }), 11030083);
+
+    const std::size_t hash_table_bytes { get_perft_hash_table_bytes() };
+    set_perft_hash_table_bytes(0);
+
+    EXPECT_EQ(perft(bitboard(STARTING_FEN), 5, { .generator=perft_generator::pseudo_legal, .strategy=perft_strategy::bulk_count }), 4865609);
+    EXPECT_EQ(perft(bitboard(POS4_FEN),     5, { .generator=perft_generator::legal, .strategy=perft_strategy::bulk_count }), 15833292);
+    EXPECT_EQ(perft(bitboard(POS5_FEN),     4, { .generator=perft_generator::legal, .strategy=perft_strategy::bulk_count, .threads=4 }), 2103487);
+    EXPECT_EQ(perft(bitboard(POS6_FEN),     4, { .generator=perft_generator::pseudo_legal, .strategy=perft_strategy::bulk_count }), 3894594);
+
+    set_perft_hash_table_bytes(hash_table_bytes);
+}
+
+// The verifying walk should count the same nodes, and never find the incremental hash or evaluation out of step.
+TEST(Perft, Verify)
+{
+    EXPECT_EQ(perft_verify(bitboard(STARTING_FEN), 4), 197281);
+    EXPECT_EQ(perft_verify(bitboard(KIWIPETE_FEN), 3), 97862);
+    EXPECT_EQ(perft_verify(bitboard(POS3_FEN),     5, perft_generator::legal), 674624);
+    EXPECT_EQ(perft_verify(bitboard(POS4_FEN),     4), 422333);
+    EXPECT_EQ(perft_verify(bitboard(POS5_FEN),     3, perft_generator::legal), 62379);
+    EXPECT_EQ(perft_verify(bitboard(POS6_FEN),     3), 89890);
+}
+
+TEST(Perft, SuitePosition)
+{
+    const auto position { parse_perft_suite_position("8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1 ;D2 126 ;id \"ep\" ;D1 15") };
+    EXPECT_EQ(position.fen, "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1");
+    ASSERT_EQ(position.expected.size(), 2);
+    EXPECT_EQ(position.expected[0].depth, 1);
+    EXPECT_EQ(position.expected[0].nodes, 15);
+    EXPECT_EQ(position.expected[1].depth, 2);
+    EXPECT_EQ(position.expected[1].nodes, 126);
+
+    // The move counters are optional.
+    EXPECT_EQ(parse_perft_suite_position("4k3/8/8/8/8/8/8/4K2R w K - ;D1 15").fen, "4k3/8/8/8/8/8/8/4K2R w K - 0 1");
+
+    EXPECT_THROW(parse_perft_suite_position("4k3/8/8/8/8/8/8/4K2R w K - 0 1"), std::invalid_argument);
+    EXPECT_THROW(parse_perft_suite_position("4k3/8/8/8/8/8/8/4K2R w ;D1 15"), std::invalid_argument);
+    EXPECT_THROW(parse_perft_suite_position("4k3/8/8/8/8/8/8/4K2R w K - 0 1 ;D1"), std::invalid_argument);
+}
+
 // Tests performant perft correctness across a variety of positions.
 int main(int argc, char **argv)
 {
@@ -65,7 +65,7 @@ TEST(Puzzle, Material500)
 int main(int argc, char **argv)
 {
     // Allocate 128 MB for our transposition table.
-    s.gs.tt.set_table_bytes(128*1000000ULL);
+    s.gs.tt->set_table_bytes(128*1000000ULL);
 
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
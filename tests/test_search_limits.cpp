@@ -0,0 +1,90 @@
+#include "search/search.hpp"
+#include "search/statistics.hpp"
+#include "position/move.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+namespace
+{
+
+const std::string STARTING_POSITION { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1" };
+
+// A fresh search of the given position, with a small transposition table.
+game_state get_game_state(const std::string& fen)
+{
+    game_state gs;
+    gs.reset();
+    gs.load(bitboard(fen));
+    gs.tt->set_table_bytes(16*1000000ULL);
+    return gs;
+}
+
+// The limits are tested without a time limit getting in the way.
+const search::time_manager NO_TIME_LIMIT { search::time_manager::fixed(std::chrono::hours(1)) };
+
+}
+
+TEST(SearchLimits, Depth)
+{
+    game_state gs { get_game_state(STARTING_POSITION) };
+    search::statistics stats {};
+    search::recommend_move(gs, stats, { .depth=5 }, NO_TIME_LIMIT);
+    EXPECT_EQ(stats.depth, 5);
+}
+
+TEST(SearchLimits, Nodes)
+{
+    // A node-limited search stays within its budget, and searches the same tree every time on a single thread.
+    const search::limits limits { .nodes=50000 };
+
+    game_state gs_a { get_game_state(STARTING_POSITION) };
+    search::statistics stats_a {};
+    const search::recommendation rec_a { search::recommend_move(gs_a, stats_a, limits, NO_TIME_LIMIT) };
+
+    game_state gs_b { get_game_state(STARTING_POSITION) };
+    search::statistics stats_b {};
+    const search::recommendation rec_b { search::recommend_move(gs_b, stats_b, limits, NO_TIME_LIMIT) };
+
+    EXPECT_LE(stats_a.get_nodes(), limits.nodes);
+    EXPECT_GT(stats_a.depth, 1);
+    EXPECT_EQ(stats_a.depth, stats_b.depth);
+    EXPECT_EQ(stats_a.get_nodes(), stats_b.get_nodes());
+    EXPECT_TRUE(move::move_is_equal(rec_a.move, rec_b.move));
+}
+
+TEST(SearchLimits, Mate)
+{
+    // A back-rank mate in one is found without searching any deeper than two ply.
+    game_state gs { get_game_state("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1") };
+    search::statistics stats {};
+    const search::recommendation rec { search::recommend_move(gs, stats, { .mate=1 }, NO_TIME_LIMIT) };
+
+    EXPECT_LE(stats.depth, 2);
+    EXPECT_EQ(rec.eval, evaluation::EVAL_CHECKMATE);
+    EXPECT_EQ(move::to_algebraic_long(rec.move), "d1d8");
+}
+
+TEST(SearchLimits, RootMoves)
+{
+    // Only the given moves are considered at the root, however bad they are.
+    game_state gs { get_game_state(STARTING_POSITION) };
+    const std::uint32_t move { move::from_algebraic_long("g1h3", gs.bb) };
+    const std::uint32_t other_move { move::from_algebraic_long("f2f3", gs.bb) };
+
+    const search::recommendation rec { search::recommend_move(gs, { .depth=6, .root_moves={ move, other_move } }, NO_TIME_LIMIT) };
+    EXPECT_TRUE(move::move_is_equal(rec.move, move) || move::move_is_equal(rec.move, other_move));
+
+    // The score of the restricted root isn't the score of the position, so it mustn't be left in the transposition table.
+    ::details::search_value_type entry {};
+    EXPECT_FALSE(gs.tt->probe(gs.hash, entry));
+}
+
+// Tests the depth, node, mate, and root move limits of the search.
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+#include "search/time_manager.hpp"
+#include "search/statistics.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+using search::time_manager;
+
+namespace
+{
+
+// The statistics after an iteration that took the given time, with the given branching factor.
+search::statistics get_iteration_stats(std::chrono::duration<double> time, double branching_factor)
+{
+    search::statistics ret {};
+    ret.prev_iteration_nodes = 1000;
+    ret.iteration_nodes      = static_cast<std::size_t>(1000 * branching_factor);
+    ret.iteration_time       = std::chrono::duration_cast<std::chrono::steady_clock::duration>(time);
+    return ret;
+}
+
+}
+
+TEST(TimeManager, Unlimited)
+{
+    time_manager tm;
+    tm.start();
+    EXPECT_FALSE(tm.get_hard_limit().has_value());
+    EXPECT_FALSE(tm.get_soft_limit().has_value());
+    EXPECT_TRUE(tm.update(get_iteration_stats(std::chrono::hours(1), 8.0), 1, 0));
+}
+
+TEST(TimeManager, Fixed)
+{
+    time_manager tm { time_manager::fixed(std::chrono::seconds(10)) };
+    tm.start();
+    EXPECT_DOUBLE_EQ(tm.get_hard_limit()->count(), 10.0);
+    EXPECT_FALSE(tm.get_soft_limit().has_value());
+
+    // We don't stop early for a stable best move, only if the next iteration won't finish in time.
+    for (std::size_t i = 0; i < 10; i++)
+        EXPECT_TRUE(tm.update(get_iteration_stats(std::chrono::milliseconds(1), 2.0), 1, 0));
+    EXPECT_FALSE(tm.update(get_iteration_stats(std::chrono::seconds(6), 2.0), 1, 0));
+}
+
+TEST(TimeManager, Clock)
+{
+    const double overhead { time_manager::MOVE_OVERHEAD.count() };
+
+    // Sudden death spends a share of the remaining time and half the increment, with a hard deadline a few times that.
+    const time_manager sudden_death { time_manager::from_clock(std::chrono::seconds(60), std::chrono::seconds(1)) };
+    const double soft { (60.0 - overhead)/time_manager::DEFAULT_MOVESTOGO + 0.5 };
+    EXPECT_DOUBLE_EQ(sudden_death.get_soft_limit()->count(), soft);
+    EXPECT_DOUBLE_EQ(sudden_death.get_hard_limit()->count(), soft*time_manager::HARD_RATIO);
+
+    // With few moves to go, the hard deadline is capped to leave time for the rest of the moves.
+    const time_manager two_to_go { time_manager::from_clock(std::chrono::seconds(60), std::chrono::seconds(0), 2) };
+    EXPECT_DOUBLE_EQ(two_to_go.get_hard_limit()->count(), (60.0 - overhead)*time_manager::HARD_MAX_USAGE);
+    EXPECT_DOUBLE_EQ(two_to_go.get_soft_limit()->count(), (60.0 - overhead)/2.0);
+
+    // Unless this is the last move before the time control.
+    const time_manager one_to_go { time_manager::from_clock(std::chrono::seconds(60), std::chrono::seconds(0), 1) };
+    EXPECT_DOUBLE_EQ(one_to_go.get_hard_limit()->count(), 60.0 - overhead);
+    EXPECT_DOUBLE_EQ(one_to_go.get_soft_limit()->count(), 60.0 - overhead);
+
+    // We never plan on spending the time we don't have.
+    const time_manager flagging { time_manager::from_clock(std::chrono::milliseconds(1), std::chrono::seconds(0)) };
+    EXPECT_DOUBLE_EQ(flagging.get_hard_limit()->count(), 0.0);
+}
+
+TEST(TimeManager, Stability)
+{
+    time_manager tm { time_manager::from_clock(std::chrono::seconds(100), std::chrono::seconds(0)) };
+    tm.start();
+    const double soft { tm.get_soft_limit()->count() };
+    const auto stats { get_iteration_stats(std::chrono::milliseconds(1), 2.0) };
+
+    // The soft deadline shrinks as the best move stays the same.
+    EXPECT_TRUE(tm.update(stats, 1, 0));
+    EXPECT_DOUBLE_EQ(tm.get_soft_limit()->count(), soft);
+    for (std::size_t i = 0; i < time_manager::STABLE_ITERATIONS; i++)
+        EXPECT_TRUE(tm.update(stats, 1, 0));
+    EXPECT_DOUBLE_EQ(tm.get_soft_limit()->count(), soft*time_manager::STABLE_SCALE);
+    for (std::size_t i = 0; i < time_manager::STABLE_ITERATIONS; i++)
+        EXPECT_TRUE(tm.update(stats, 1, 0));
+    EXPECT_DOUBLE_EQ(tm.get_soft_limit()->count(), soft*time_manager::VERY_STABLE_SCALE);
+
+    // And grows when the best move changes, and further if the score drops too.
+    EXPECT_TRUE(tm.update(stats, 2, 0));
+    EXPECT_DOUBLE_EQ(tm.get_soft_limit()->count(), soft*time_manager::UNSTABLE_SCALE);
+    EXPECT_TRUE(tm.update(stats, 3, -time_manager::SCORE_DROP_MARGIN));
+    EXPECT_DOUBLE_EQ(tm.get_soft_limit()->count(), soft*time_manager::UNSTABLE_SCALE*time_manager::SCORE_DROP_SCALE);
+
+    // A small drop in score doesn't count.
+    EXPECT_TRUE(tm.update(stats, 3, -time_manager::SCORE_DROP_MARGIN-1));
+    EXPECT_DOUBLE_EQ(tm.get_soft_limit()->count(), soft);
+}
+
+TEST(TimeManager, Prediction)
+{
+    // The hard deadline is just under 20 seconds, so an iteration predicted to take longer than that isn't started.
+    time_manager tm { time_manager::from_clock(std::chrono::seconds(100), std::chrono::seconds(0)) };
+    tm.start();
+    ASSERT_DOUBLE_EQ(tm.get_hard_limit()->count(), (100.0 - time_manager::MOVE_OVERHEAD.count())/time_manager::DEFAULT_MOVESTOGO*time_manager::HARD_RATIO);
+
+    EXPECT_TRUE (tm.update(get_iteration_stats(std::chrono::seconds(4), 4.0), 1, 0));
+    EXPECT_FALSE(tm.update(get_iteration_stats(std::chrono::seconds(4), 6.0), 1, 0));
+
+    // Without a branching factor to go on we use the default, and odd iterations are capped.
+    tm.start();
+    EXPECT_TRUE (tm.update(get_iteration_stats(std::chrono::seconds(9), 0.0), 1, 0));
+    EXPECT_FALSE(tm.update(get_iteration_stats(std::chrono::seconds(11), 0.0), 1, 0));
+    tm.start();
+    EXPECT_TRUE (tm.update(get_iteration_stats(std::chrono::seconds(2), 100.0), 1, 0));
+}
+
+// Tests the decisions of the time manager, which don't depend on the search itself.
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,92 @@
+#include "config.hpp"
+#include "search/search.hpp"
+#include "position/move.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const std::vector<std::string> POSITIONS
+{
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"
+};
+
+// Searches each of the positions to the given depth, checking that it comes back with a move.
+void test_search(std::size_t depth)
+{
+    for (const auto& fen : POSITIONS)
+    {
+        game_state gs;
+        gs.reset();
+        gs.load(bitboard(fen));
+        gs.tt->set_table_bytes(16*1000000ULL);
+
+        search::statistics stats {};
+        const search::recommendation rec { search::recommend_move(gs, stats, { .depth=depth }, search::time_manager::fixed(std::chrono::minutes(1))) };
+        EXPECT_NE(rec.move, 0U) << fen;
+        EXPECT_EQ(stats.depth, depth) << fen;
+    }
+}
+
+}
+
+TEST(Tunable, ExtremeValues)
+{
+    if (config::tunable_parameters.empty())
+        GTEST_SKIP() << "The search parameters are only settable in WAYCHESS_TUNABLE builds.";
+
+    // Every numeric parameter at both ends of its range (one at a time) has to give a working search.
+    for (const auto& p : config::tunable_parameters)
+    {
+        const auto value = std::get_if<int*>(&p.value);
+        if (!value)
+            continue;
+
+        const int initial { **value };
+        for (const int v : { p.min, p.max })
+        {
+            SCOPED_TRACE(std::string(p.name) + "=" + std::to_string(v));
+            **value = v;
+            test_search(6);
+        }
+        **value = initial;
+    }
+}
+
+TEST(Tunable, LargeReductions)
+{
+    if (config::tunable_parameters.empty())
+        GTEST_SKIP() << "The search parameters are only settable in WAYCHESS_TUNABLE builds.";
+
+    // The most aggressive LMR reduces far more than the remaining depth, which the search should just cap.
+    const auto get_parameter = [] (std::string_view name) -> int&
+    {
+        return *std::get<int*>(std::ranges::find(config::tunable_parameters, name, &config::tunable_parameter::name)->value);
+    };
+
+    int& lmr_base { get_parameter("lmr_base") };
+    int& lmr_divisor { get_parameter("lmr_divisor") };
+    const int initial_base { lmr_base }, initial_divisor { lmr_divisor };
+
+    lmr_base = 500;
+    lmr_divisor = 50;
+    test_search(8);
+
+    lmr_base = initial_base;
+    lmr_divisor = initial_divisor;
+}
+
+// Tests that the search stays sound over the ranges of the parameters that can be set at runtime (in tunable builds).
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,152 @@
+#include "evaluation/tuning.hpp"
+#include "position/bitboard.hpp"
+#include "position/game_state.hpp"
+#include "position/generate_moves.hpp"
+#include "position/make_move.hpp"
+
+#include "test_positions.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace tuning = evaluation::tuning;
+
+namespace
+{
+
+// Checks that the features (with the compiled-in weights) give back the same evaluation as the engine itself. The engine
+// interpolates in integers, so we can be out by the rounding.
+void test_features_recursive(game_state& gs, const tuning::weights& w, std::size_t depth)
+{
+    std::vector<tuning::feature> features;
+    tuning::get_features(gs.bb, features);
+
+    const int gp { std::min(evaluation::evaluate_gp(gs.bb), 24) };
+    ASSERT_NEAR(tuning::evaluate(w, features, gp), gs.evaluate(), 1.0) << gs.bb.get_fen_string();
+
+    if (depth == 0)
+        return;
+
+    std::array<std::uint32_t, MAX_MOVES_PER_POSITION> move_buf;
+    const std::size_t moves { generate_pseudo_legal_moves(gs.bb, std::span<std::uint32_t>(move_buf)) };
+    for (std::size_t i = 0; i < moves; i++)
+    {
+        std::uint32_t unmake;
+        if (make_move({ .check_legality = true }, gs, move_buf[i], unmake))
+            test_features_recursive(gs, w, depth-1);
+        unmake_move(gs, move_buf[i], unmake);
+    }
+}
+
+void test_features(const char* fen, std::size_t depth)
+{
+    game_state gs;
+    gs.reset();
+    gs.load(bitboard(fen));
+    test_features_recursive(gs, tuning::get_default_weights(), depth);
+}
+
+}
+
+TEST(Tuning, FeatureEncoding)
+{
+    for (const int coef : { -32, -27, -1, 1, 8, 31 })
+        for (const std::size_t idx : { std::size_t {}, tuning::PARAMETERS-1 })
+        {
+            const tuning::feature f { tuning::encode_feature(idx, coef) };
+            ASSERT_EQ(tuning::decode_feature_idx(f), idx);
+            ASSERT_EQ(tuning::decode_feature_coef(f), coef);
+        }
+}
+
+TEST(Tuning, Features)
+{
+    test_features(STARTING_FEN, 3);
+    test_features(KIWIPETE_FEN, 2);
+    test_features(POS3_FEN,     3);
+    test_features(POS4_FEN,     2);
+    test_features(POS5_FEN,     2);
+}
+
+TEST(Tuning, ParseLabelledPosition)
+{
+    bitboard bb;
+    double result;
+
+    tuning::parse_labelled_position(R"(rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - c9 "1/2-1/2";)", bb, result);
+    ASSERT_EQ(bb.get_fen_string(), STARTING_FEN);
+    ASSERT_EQ(result, 0.5);
+
+    tuning::parse_labelled_position(R"(r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - c9 "0-1";)", bb, result);
+    ASSERT_EQ(bb.get_fen_string(), KIWIPETE_FEN);
+    ASSERT_EQ(result, 0.0);
+
+    tuning::parse_labelled_position("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1 [1.0]", bb, result);
+    ASSERT_EQ(bb.get_fen_string(), KIWIPETE_FEN);
+    ASSERT_EQ(result, 1.0);
+
+    tuning::parse_labelled_position("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -,0.5", bb, result);
+    ASSERT_EQ(bb.get_fen_string(), KIWIPETE_FEN);
+    ASSERT_EQ(result, 0.5);
+
+    // Headers, missing results, bad FENs and missing kings.
+    ASSERT_THROW(tuning::parse_labelled_position("fen,result", bb, result), std::logic_error);
+    ASSERT_THROW(tuning::parse_labelled_position(STARTING_FEN, bb, result), std::logic_error);
+    ASSERT_THROW(tuning::parse_labelled_position("rnbqkbnr/pppppppp w KQkq - [1.0]", bb, result), std::logic_error);
+    ASSERT_THROW(tuning::parse_labelled_position("8/8/8/8/8/8/8/K7 w - - [1.0]", bb, result), std::logic_error);
+    ASSERT_THROW(tuning::parse_labelled_position("8/8/8/8/8/8/8/K6k w - - [2.0]", bb, result), std::logic_error);
+}
+
+TEST(Tuning, Gradient)
+{
+    tuning::dataset data;
+    data.add(bitboard(STARTING_FEN), 0.5);
+    data.add(bitboard(KIWIPETE_FEN), 1.0);
+    data.add(bitboard(POS3_FEN),     0.0);
+    data.add(bitboard(POS4_FEN),     0.5);
+    data.add(bitboard(POS5_FEN),     1.0);
+
+    const tuning::weights w { tuning::get_default_weights() };
+    constexpr double k { 1.2 };
+
+    tuning::weights gradient;
+    const double error { tuning::get_error(data, w, k, 2, &gradient) };
+    ASSERT_DOUBLE_EQ(error, tuning::get_error(data, w, k, 1));
+
+    // Compare against central differences for a handful of the parameters.
+    constexpr double h { 1e-3 };
+    for (const std::size_t idx : { tuning::MATERIAL_OFFSET + piece_idx::w_knight, tuning::PIECE_SQUARE_OFFSET + 8, tuning::ISOLATED_PAWNS, tuning::KING_MOBILITY })
+    {
+        tuning::weights plus { w }, minus { w };
+        plus[idx].mg += h; minus[idx].mg -= h;
+        ASSERT_NEAR(gradient[idx].mg, (tuning::get_error(data, plus, k, 1) - tuning::get_error(data, minus, k, 1))/(2*h), 1e-8);
+
+        plus = w; minus = w;
+        plus[idx].eg += h; minus[idx].eg -= h;
+        ASSERT_NEAR(gradient[idx].eg, (tuning::get_error(data, plus, k, 1) - tuning::get_error(data, minus, k, 1))/(2*h), 1e-8);
+    }
+}
+
+TEST(Tuning, Header)
+{
+    // The parameters header is always exactly what the tuner would write for its own weights.
+    std::ifstream ifs(PARAMETERS_HPP);
+    ASSERT_TRUE(ifs);
+    std::stringstream expected;
+    expected << ifs.rdbuf();
+
+    std::stringstream actual;
+    tuning::write_header(actual, tuning::get_default_weights());
+    ASSERT_EQ(actual.str(), expected.str());
+}
+
+// Test correctness of the evaluation tuner.
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}